@@ -0,0 +1,112 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_BENCHMARK_ARM_MODEL_H
+#define REACH_ROS_BENCHMARK_ARM_MODEL_H
+
+#include <geometric_shapes/shape_operations.h>
+#include <moveit/collision_detection/world.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace reach_ros
+{
+namespace benchmarks
+{
+/** @brief Name of the planning group of the arm model */
+const std::string ARM_GROUP = "manipulator";
+
+/** @brief Returns a pose translated along the Z-axis */
+inline geometry_msgs::Pose createZPose(double z)
+{
+  geometry_msgs::Pose pose;
+  pose.position.x = 0.0;
+  pose.position.y = 0.0;
+  pose.position.z = z;
+  pose.orientation.x = 0.0;
+  pose.orientation.y = 0.0;
+  pose.orientation.z = 0.0;
+  pose.orientation.w = 1.0;
+  return pose;
+}
+
+/**
+ * @brief Builds a 7-DOF arm with roughly the link lengths and alternating joint axes of the SIA20D demo robot, whose
+ * links have box collision geometry
+ * @details The model is built in memory, so benchmarks using it do not need a ROS master or a robot description on the
+ * parameter server
+ */
+inline moveit::core::RobotModelPtr createArmModel()
+{
+  struct Link
+  {
+    std::string name;
+    double length;
+    urdf::Vector3 axis;
+  };
+
+  const urdf::Vector3 roll(0.0, 0.0, 1.0);
+  const urdf::Vector3 pitch(0.0, 1.0, 0.0);
+  const std::vector<Link> links = {
+    { "link_s", 0.41, roll }, { "link_l", 0.0, pitch }, { "link_e", 0.49, roll }, { "link_u", 0.0, pitch },
+    { "link_r", 0.42, roll }, { "link_b", 0.0, pitch }, { "link_t", 0.18, roll },
+  };
+
+  // Links shorter than their width are modelled as cubes about their joint
+  const double width = 0.12;
+
+  moveit::core::RobotModelBuilder builder("arm", "base_link");
+  std::string parent = "base_link";
+  double parent_length = 0.1;
+  builder.addCollisionBox(parent, { 0.3, 0.3, parent_length }, createZPose(parent_length / 2.0));
+  for (const Link& link : links)
+  {
+    // Each joint is at the end of its parent link
+    builder.addChain(parent + "->" + link.name, "revolute", { createZPose(parent_length) }, link.axis);
+    builder.addCollisionBox(link.name, { width, width, std::max(link.length, width) },
+                            createZPose(link.length / 2.0));
+
+    parent = link.name;
+    parent_length = link.length;
+  }
+
+  builder.addGroupChain("base_link", parent, ARM_GROUP);
+  if (!builder.isValid())
+    throw std::runtime_error("Failed to build the arm model");
+
+  return builder.build();
+}
+
+/** @brief Creates a collision world containing the demo part, in the frame of the arm model */
+inline collision_detection::WorldPtr createPartWorld()
+{
+  shapes::ShapePtr part(shapes::createMeshFromResource("file://" REACH_ROS_DEMO_PART_FILENAME));
+  if (!part)
+    throw std::runtime_error("Failed to load the demo part '" REACH_ROS_DEMO_PART_FILENAME "'");
+
+  auto world = std::make_shared<collision_detection::World>();
+  world->addToObject("part", part, Eigen::Isometry3d::Identity());
+  return world;
+}
+
+}  // namespace benchmarks
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_BENCHMARK_ARM_MODEL_H
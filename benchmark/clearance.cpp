@@ -0,0 +1,123 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "arm_model.h"
+#include <reach_ros/utils.h>
+
+#include <benchmark/benchmark.h>
+#include <moveit/collision_detection_fcl/collision_env_fcl.h>
+#include <moveit/robot_state/robot_state.h>
+#include <random_numbers/random_numbers.h>
+#include <vector>
+
+namespace
+{
+/** @brief Clearance required of the robot, as the distance_threshold of the demo distance penalty evaluator */
+const double DISTANCE_THRESHOLD = 0.025;
+
+/** @brief Number of robot states checked by every iteration */
+const std::size_t N_STATES = 1000;
+
+/**
+ * @brief Robot states and the world containing the demo part, shared by the clearance benchmarks
+ * @details The benchmarks compare the cost and the agreement of the distance and padding clearance modes; no results
+ * have been recorded yet, so the relative cost of the modes is unmeasured
+ */
+struct ClearanceFixture
+{
+  ClearanceFixture() : model(reach_ros::benchmarks::createArmModel()), world(reach_ros::benchmarks::createPartWorld())
+  {
+    // Random states with a fixed seed, so both clearance modes check the same states
+    const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(reach_ros::benchmarks::ARM_GROUP);
+    random_numbers::RandomNumberGenerator rng(0);
+    states.reserve(N_STATES);
+    for (std::size_t i = 0; i < N_STATES; ++i)
+    {
+      moveit::core::RobotState state(model);
+      state.setToDefaultValues();
+      state.setToRandomPositions(jmg, rng);
+      state.update();
+      states.push_back(state);
+    }
+  }
+
+  moveit::core::RobotModelPtr model;
+  collision_detection::WorldPtr world;
+  collision_detection::AllowedCollisionMatrix acm;
+  std::vector<moveit::core::RobotState> states;
+};
+
+const ClearanceFixture& getFixture()
+{
+  static const ClearanceFixture fixture;
+  return fixture;
+}
+
+}  // namespace
+
+namespace reach_ros
+{
+namespace benchmarks
+{
+/** @brief Checks the clearance of every state with an exact distance query, as the distance clearance mode does */
+static void distanceClearance(benchmark::State& st)
+{
+  const ClearanceFixture& fixture = getFixture();
+  collision_detection::CollisionEnvFCL env(fixture.model, fixture.world);
+
+  std::size_t n_rejected = 0;
+  for (auto _ : st)
+  {
+    for (const moveit::core::RobotState& state : fixture.states)
+    {
+      if (utils::getDistanceToWorld(env, state, fixture.acm, {}) < DISTANCE_THRESHOLD)
+        ++n_rejected;
+    }
+  }
+
+  st.SetItemsProcessed(st.iterations() * fixture.states.size());
+  st.counters["rejected"] = benchmark::Counter(double(n_rejected), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(distanceClearance)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Checks the clearance of every state with a collision check of links padded by the distance threshold, as the
+ * padding clearance mode does
+ */
+static void paddingClearance(benchmark::State& st)
+{
+  const ClearanceFixture& fixture = getFixture();
+  collision_detection::CollisionEnvFCL env(fixture.model, fixture.world, DISTANCE_THRESHOLD);
+
+  std::size_t n_rejected = 0;
+  for (auto _ : st)
+  {
+    for (const moveit::core::RobotState& state : fixture.states)
+    {
+      collision_detection::CollisionRequest req;
+      collision_detection::CollisionResult res;
+      env.checkRobotCollision(req, res, state, fixture.acm);
+      if (res.collision)
+        ++n_rejected;
+    }
+  }
+
+  st.SetItemsProcessed(st.iterations() * fixture.states.size());
+  st.counters["rejected"] = benchmark::Counter(double(n_rejected), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(paddingClearance)->Unit(benchmark::kMillisecond);
+
+}  // namespace benchmarks
+}  // namespace reach_ros
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_BENCHMARK_DEMO_ROBOT_H
+#define REACH_ROS_BENCHMARK_DEMO_ROBOT_H
+
+#include <reach_ros/ik/moveit_ik_solver.h>
+#include <reach_ros/utils.h>
+
+#include <map>
+#include <memory>
+#include <moveit/common_planning_interface_objects/common_objects.h>
+#include <moveit/kinematics_base/kinematics_base.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <random_numbers/random_numbers.h>
+#include <string>
+#include <vector>
+
+namespace reach_ros
+{
+namespace benchmarks
+{
+/** @brief Planning group of the demo robot */
+const std::string DEMO_GROUP = "manipulator";
+
+/**
+ * @brief MoveIt! IK solver of the demo robot (SIA20D) with the demo part as its collision mesh, and targets reachable
+ * by the robot
+ * @details Unlike the in-memory arm model, the demo robot has a kinematics plugin (KDL), so the benchmarks using it
+ * measure complete IK solves. They need the demo robot description on the parameter server (`roslaunch reach_ros
+ * robot.launch` from the demo configuration) and are skipped otherwise
+ */
+struct DemoSolverFixture
+{
+  explicit DemoSolverFixture(std::size_t n_targets)
+  {
+    utils::initROS("reach_ros_benchmark");
+    model = moveit::planning_interface::getSharedRobotModel("robot_description");
+    if (!model)
+      return;
+
+    solver = std::make_shared<ik::MoveItIKSolver>(model, DEMO_GROUP, 0.0);
+    solver->addCollisionMesh("package://reach_ros/demo/config/part.ply", "base_link");
+
+    const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(DEMO_GROUP);
+    for (const std::string& name : jmg->getActiveJointModelNames())
+      seed[name] = 0.0;
+
+    // Targets at the tip of the robot in random states, which are reachable (though they may be in collision)
+    std::string tip_frame = jmg->getSolverInstance()->getTipFrame();
+    if (!tip_frame.empty() && tip_frame.front() == '/')
+      tip_frame.erase(0, 1);
+
+    random_numbers::RandomNumberGenerator rng(0);
+    moveit::core::RobotState state(model);
+    state.setToDefaultValues();
+    for (std::size_t i = 0; i < n_targets; ++i)
+    {
+      state.setToRandomPositions(jmg, rng);
+      state.update();
+      targets.push_back(state.getGlobalLinkTransform(tip_frame));
+    }
+  }
+
+  moveit::core::RobotModelConstPtr model;
+  std::shared_ptr<ik::MoveItIKSolver> solver;
+  std::map<std::string, double> seed;
+  std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> targets;
+};
+
+}  // namespace benchmarks
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_BENCHMARK_DEMO_ROBOT_H
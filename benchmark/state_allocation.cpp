@@ -0,0 +1,143 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "arm_model.h"
+#include "demo_robot.h"
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <moveit/robot_state/robot_state.h>
+#include <new>
+
+namespace
+{
+/** @brief Number of heap allocations made by the process, counted by the replacement of the global operator new */
+std::atomic<std::size_t> n_allocations{ 0 };
+
+/** @brief Positions of the planning group joints set by every iteration, as IK sets the seed of every solve */
+std::vector<double> getSeed(const moveit::core::JointModelGroup* jmg)
+{
+  return std::vector<double>(jmg->getVariableCount(), 0.1);
+}
+
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+  n_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace reach_ros
+{
+namespace benchmarks
+{
+/**
+ * @brief Constructs a robot state for every solve, as MoveItIKSolver::solveIK did before per-thread contexts
+ * @details This and reuseState are a proxy measurement of the state handling of a solve on the in-memory arm model; they
+ * do not call solveIK. See solveIK for complete solves
+ */
+static void constructState(benchmark::State& st)
+{
+  const moveit::core::RobotModelPtr model = createArmModel();
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(ARM_GROUP);
+  const std::vector<double> seed = getSeed(jmg);
+
+  const std::size_t start = n_allocations.load();
+  for (auto _ : st)
+  {
+    moveit::core::RobotState state(model);
+    state.setToDefaultValues();
+    state.setJointGroupPositions(jmg, seed);
+    state.update();
+    benchmark::DoNotOptimize(state.getGlobalLinkTransform("link_t"));
+  }
+
+  st.counters["allocations"] =
+      benchmark::Counter(double(n_allocations.load() - start), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(constructState);
+
+/**
+ * @brief Re-seeds the robot state of the calling thread for every solve, as MoveItIKSolver::solveIK does (a proxy
+ * measurement, see constructState)
+ */
+static void reuseState(benchmark::State& st)
+{
+  const moveit::core::RobotModelPtr model = createArmModel();
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(ARM_GROUP);
+  const std::vector<double> seed = getSeed(jmg);
+
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+
+  const std::size_t start = n_allocations.load();
+  for (auto _ : st)
+  {
+    state.setJointGroupPositions(jmg, seed);
+    state.update();
+    benchmark::DoNotOptimize(state.getGlobalLinkTransform("link_t"));
+  }
+
+  st.counters["allocations"] =
+      benchmark::Counter(double(n_allocations.load() - start), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(reuseState);
+
+/**
+ * @brief Solves IK for targets of the demo robot on the calling thread, including the kinematics solver and the
+ * collision checks, and counts the heap allocations of each solve
+ * @details Requires the demo robot description (see DemoSolverFixture)
+ */
+static void solveIK(benchmark::State& st)
+{
+  static const DemoSolverFixture fixture(64);
+  if (!fixture.solver)
+  {
+    st.SkipWithError("The demo robot description is not on the parameter server");
+    return;
+  }
+
+  // Allocate the context of the calling thread before counting
+  fixture.solver->solveIK(fixture.targets.front(), fixture.seed);
+
+  std::size_t i = 0;
+  const std::size_t start = n_allocations.load();
+  for (auto _ : st)
+  {
+    benchmark::DoNotOptimize(fixture.solver->solveIK(fixture.targets[i], fixture.seed));
+    i = (i + 1) % fixture.targets.size();
+  }
+
+  st.counters["allocations"] =
+      benchmark::Counter(double(n_allocations.load() - start), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(solveIK)->Unit(benchmark::kMicrosecond);
+
+}  // namespace benchmarks
+}  // namespace reach_ros
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "arm_model.h"
+#include "demo_robot.h"
+#include <reach_ros/utils.h>
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <moveit/collision_detection_fcl/collision_env_fcl.h>
+#include <moveit/robot_state/robot_state.h>
+#include <random_numbers/random_numbers.h>
+#include <vector>
+
+namespace
+{
+/** @brief Number of solution checks made by every iteration */
+const std::size_t N_CHECKS = 4096;
+
+/** @brief Candidate IK solutions and the collision environment of the demo part, shared by all threads */
+struct ScalingFixture
+{
+  ScalingFixture()
+    : model(reach_ros::benchmarks::createArmModel())
+    , jmg(model->getJointModelGroup(reach_ros::benchmarks::ARM_GROUP))
+    , env(model, reach_ros::benchmarks::createPartWorld())
+  {
+    random_numbers::RandomNumberGenerator rng(0);
+    moveit::core::RobotState state(model);
+    state.setToDefaultValues();
+    solutions.reserve(N_CHECKS);
+    for (std::size_t i = 0; i < N_CHECKS; ++i)
+    {
+      state.setToRandomPositions(jmg, rng);
+      std::vector<double> solution;
+      state.copyJointGroupPositions(jmg, solution);
+      solutions.push_back(solution);
+    }
+  }
+
+  moveit::core::RobotModelPtr model;
+  const moveit::core::JointModelGroup* jmg;
+  collision_detection::CollisionEnvFCL env;
+  collision_detection::AllowedCollisionMatrix acm;
+  std::vector<std::vector<double>> solutions;
+};
+
+const ScalingFixture& getFixture()
+{
+  static const ScalingFixture fixture;
+  return fixture;
+}
+
+/** @brief Number of targets solved by every iteration */
+const std::size_t N_TARGETS = 256;
+
+const reach_ros::benchmarks::DemoSolverFixture& getDemoFixture()
+{
+  static const reach_ros::benchmarks::DemoSolverFixture fixture(N_TARGETS);
+  return fixture;
+}
+
+}  // namespace
+
+namespace reach_ros
+{
+namespace benchmarks
+{
+/**
+ * @brief Checks the validity of candidate IK solutions on the process-wide thread pool, each thread with its own robot
+ * state, as the workers of MoveItIKSolver do
+ * @details The kinematics solver itself is not part of the benchmark, since the in-memory arm model has no kinematics
+ * plugin. The argument is the maximum number of threads
+ */
+static void checkSolutionsInParallel(benchmark::State& st)
+{
+  const ScalingFixture& fixture = getFixture();
+  const std::size_t n_threads = static_cast<std::size_t>(st.range(0));
+
+  std::atomic<std::size_t> n_valid{ 0 };
+  for (auto _ : st)
+  {
+    utils::parallelFor(fixture.solutions.size(), n_threads, [&](std::size_t i) {
+      thread_local moveit::core::RobotState state(fixture.model);
+      state.setJointGroupPositions(fixture.jmg, fixture.solutions[i]);
+      state.update();
+
+      collision_detection::CollisionRequest req;
+      collision_detection::CollisionResult res;
+      fixture.env.checkRobotCollision(req, res, state, fixture.acm);
+      if (!res.collision)
+        n_valid.fetch_add(1, std::memory_order_relaxed);
+
+      return true;
+    });
+  }
+
+  st.SetItemsProcessed(st.iterations() * fixture.solutions.size());
+  st.counters["valid"] = benchmark::Counter(double(n_valid.load()), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(checkSolutionsInParallel)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Solves IK for targets of the demo robot on the process-wide thread pool with a single MoveItIKSolver, as the
+ * reach study does, such that the kinematics solver instances, robot states, and collision checks of the per-thread
+ * contexts of the solver are all part of the benchmark
+ * @details The argument is the maximum number of threads. Requires the demo robot description (see DemoSolverFixture)
+ */
+static void solveIKInParallel(benchmark::State& st)
+{
+  const DemoSolverFixture& fixture = getDemoFixture();
+  if (!fixture.solver)
+  {
+    st.SkipWithError("The demo robot description is not on the parameter server");
+    return;
+  }
+
+  const std::size_t n_threads = static_cast<std::size_t>(st.range(0));
+  std::atomic<std::size_t> n_solved{ 0 };
+  for (auto _ : st)
+  {
+    utils::parallelFor(fixture.targets.size(), n_threads, [&](std::size_t i) {
+      if (!fixture.solver->solveIK(fixture.targets[i], fixture.seed).empty())
+        n_solved.fetch_add(1, std::memory_order_relaxed);
+
+      return true;
+    });
+  }
+
+  st.SetItemsProcessed(st.iterations() * fixture.targets.size());
+  st.counters["solved"] = benchmark::Counter(double(n_solved.load()), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(solveIKInParallel)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}  // namespace benchmarks
+}  // namespace reach_ros
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_COLLISION_CLEARANCE_MODE_H
+#define REACH_ROS_COLLISION_CLEARANCE_MODE_H
+
+#include <string>
+
+namespace YAML
+{
+class Node;
+}
+
+namespace reach_ros
+{
+namespace collision
+{
+/** @brief Method by which a distance threshold between the robot and the collision mesh is enforced */
+enum class ClearanceMode
+{
+  /** @brief Compute the exact minimum distance between the robot and the collision environment */
+  DISTANCE,
+  /** @brief Check for collision between the collision environment and the robot with links padded by the distance
+     threshold */
+  PADDING,
+  /**
+   * @brief Look up the distance between spheres enclosing the robot links and the collision mesh in a precomputed
+   * signed distance field of the collision mesh
+   */
+  SDF,
+};
+
+/**
+ * @brief Parses the optional clearance mode parameter (`distance`, `padding`, or `sdf`) from a plugin configuration
+ * @return The clearance mode, or the distance clearance mode if the parameter is not set
+ * @throws std::runtime_error if the parameter is not a valid clearance mode
+ */
+ClearanceMode getClearanceMode(const YAML::Node& config, const std::string& key = "clearance_mode");
+
+}  // namespace collision
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_COLLISION_CLEARANCE_MODE_H
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_COLLISION_COLLISION_PRECHECK_H
+#define REACH_ROS_COLLISION_COLLISION_PRECHECK_H
+
+#include <reach_ros/collision/link_spheres.h>
+
+#include <memory>
+
+namespace reach_ros
+{
+namespace collision
+{
+/**
+ * @brief Pre-check of the collision between a robot and a static mesh, which decides most states without an exact
+ * collision check
+ * @details A state is clearly free if the spheres enclosing all links of the robot with collision geometry are farther
+ * from the mesh than the error of the signed distance field of the mesh plus the padding of the links. Since the field
+ * is exact up to its maximum distance, a state can only be decided free if that distance exceeds the radius of the
+ * largest sphere by the error and the padding. A state is clearly colliding if an edge of the collision geometry of a
+ * link moved by the planning group has one end inside of the mesh and the other end outside of it, each by more than
+ * that error, such that the edge (and therefore the link surface) crosses the mesh surface. The inside of an open mesh
+ * is not well defined, so states are never decided colliding if the mesh of the field is open. Only states that are
+ * neither are left to the exact check
+ */
+class CollisionPrecheck
+{
+public:
+  enum class Result
+  {
+    FREE,
+    COLLIDING,
+    UNKNOWN,
+  };
+
+  /**
+   * @param jmg Planning group whose links are checked for the colliding verdict
+   * @param excluded_links Names of links that are not checked (e.g., links allowed to touch the mesh)
+   * @param padding Padding (m) of the links in the exact check, which the free verdict must respect
+   * @param max_edges_per_shape Maximum number of edges of each collision shape (the longest) used for the colliding
+   * verdict
+   */
+  CollisionPrecheck(std::shared_ptr<const SignedDistanceField> sdf, const moveit::core::JointModelGroup* jmg,
+                    const std::vector<std::string>& excluded_links, double padding = 0.0,
+                    std::size_t max_edges_per_shape = 32);
+
+  /** @param state Robot state with up-to-date link transforms */
+  Result check(const moveit::core::RobotState& state) const;
+
+private:
+  struct Edge
+  {
+    const moveit::core::LinkModel* link;
+    /** @brief Ends of the edge, in the frame of its link */
+    Eigen::Vector3d a;
+    Eigen::Vector3d b;
+  };
+
+  std::shared_ptr<const SignedDistanceField> sdf_;
+  LinkSpheres spheres_;
+
+  /** @brief Edges of all links, grouped by link */
+  std::vector<Edge> edges_;
+
+  /**
+   * @brief Upper bound of the error of an interpolated distance of the signed distance field, with respect to the exact
+   * distance clamped to the maximum distance of the field
+   */
+  double error_;
+  double padding_;
+};
+
+}  // namespace collision
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_COLLISION_COLLISION_PRECHECK_H
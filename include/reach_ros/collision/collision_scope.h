@@ -0,0 +1,57 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_COLLISION_COLLISION_SCOPE_H
+#define REACH_ROS_COLLISION_COLLISION_SCOPE_H
+
+#include <string>
+
+namespace YAML
+{
+class Node;
+}
+
+namespace reach_ros
+{
+namespace collision
+{
+/** @brief Collision environments against which the robot is checked */
+enum class CollisionScope
+{
+  /** @brief Only the collision world (i.e., the collision mesh) */
+  WORLD,
+  /** @brief Only the robot itself */
+  SELF,
+  /** @brief Both the collision world and the robot itself */
+  BOTH,
+};
+
+/** @brief Returns true if the scope includes the collision world */
+bool includesWorld(CollisionScope scope);
+
+/** @brief Returns true if the scope includes the robot itself */
+bool includesSelf(CollisionScope scope);
+
+/**
+ * @brief Parses the optional collision scope parameter (`world`, `self`, or `both`) from a plugin configuration
+ * @param default_scope Scope returned if the parameter is not set
+ */
+CollisionScope getCollisionScope(const YAML::Node& config, CollisionScope default_scope,
+                                 const std::string& key = "collision_scope");
+
+}  // namespace collision
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_COLLISION_COLLISION_SCOPE_H
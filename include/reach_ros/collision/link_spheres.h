@@ -0,0 +1,121 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_COLLISION_LINK_SPHERES_H
+#define REACH_ROS_COLLISION_LINK_SPHERES_H
+
+#include <Eigen/Geometry>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace shapes
+{
+class Mesh;
+class Shape;
+}  // namespace shapes
+
+namespace moveit
+{
+namespace core
+{
+class JointModelGroup;
+class LinkModel;
+class RobotState;
+}  // namespace core
+}  // namespace moveit
+
+namespace reach_ros
+{
+namespace collision
+{
+class SignedDistanceField;
+
+/**
+ * @brief Returns a collision shape other than a sphere as a mesh (in the frame of the shape), or nullptr if the shape
+ * has no mesh representation
+ */
+std::shared_ptr<const shapes::Mesh> getShapeMesh(const std::shared_ptr<const shapes::Shape>& shape);
+
+/** @brief Returns the input links other than those with the excluded names, in the same order */
+std::vector<const moveit::core::LinkModel*> excludeLinks(const std::vector<const moveit::core::LinkModel*>& links,
+                                                        const std::vector<std::string>& excluded_links);
+
+/**
+ * @brief Two-level tree of spheres that encloses the collision geometry of a set of links (e.g., the links moved by a
+ * planning group)
+ * @details Each collision shape is cut into slabs along the longest axis of its bounding box, with roughly as many
+ * slabs as that axis is longer than the other axes. Each slab is enclosed by a sphere about the center of the bounding
+ * box of the part of the shape surface within the slab, which also encloses the part of the shape volume within the
+ * slab. Sphere shapes are used as they are. The spheres of each link are in turn enclosed by a bounding sphere, such
+ * that links far from the surface of a signed distance field are decided with a single lookup
+ */
+class LinkSpheres
+{
+public:
+  struct Sphere
+  {
+    const moveit::core::LinkModel* link;
+    /** @brief Center of the sphere, in the frame of its link */
+    Eigen::Vector3d center;
+    double radius;
+  };
+
+  /**
+   * @brief Creates the spheres of the links with collision geometry moved by a planning group
+   * @param excluded_links Names of links for which no spheres are created (e.g., links allowed to touch the part)
+   * @param max_spheres_per_shape Maximum number of slabs into which each collision shape is cut
+   */
+  LinkSpheres(const moveit::core::JointModelGroup* jmg, const std::vector<std::string>& excluded_links,
+              std::size_t max_spheres_per_shape = 16);
+
+  /**
+   * @brief Creates the spheres of the input links
+   * @param max_spheres_per_shape Maximum number of slabs into which each collision shape is cut
+   */
+  LinkSpheres(const std::vector<const moveit::core::LinkModel*>& links, std::size_t max_spheres_per_shape = 16);
+
+  const std::vector<Sphere>& getSpheres() const;
+
+  /**
+   * @brief Returns the minimum signed distance from any sphere to the surface of a signed distance field (in the model
+   * frame), or the maximum distance of the field if there are no spheres
+   * @param state Robot state with up-to-date link transforms
+   */
+  double getDistance(const moveit::core::RobotState& state, const SignedDistanceField& sdf) const;
+
+  /**
+   * @brief Checks whether all spheres are at least the input signed distance from the surface of a signed distance
+   * field, which is cheaper than computing the minimum distance because most links are decided by their bounding sphere
+   * @param state Robot state with up-to-date link transforms
+   */
+  bool isClearOf(const moveit::core::RobotState& state, const SignedDistanceField& sdf, double distance) const;
+
+private:
+  /** @brief Spheres of all links, grouped by link */
+  std::vector<Sphere> spheres_;
+
+  /**
+   * @brief Bounding sphere of the spheres of each link, whose spheres are those on [offsets_[i], offsets_[i + 1]) for
+   * the bounding sphere i
+   */
+  std::vector<Sphere> bounds_;
+  std::vector<std::size_t> offsets_;
+};
+
+}  // namespace collision
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_COLLISION_LINK_SPHERES_H
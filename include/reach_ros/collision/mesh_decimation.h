@@ -0,0 +1,77 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_COLLISION_MESH_DECIMATION_H
+#define REACH_ROS_COLLISION_MESH_DECIMATION_H
+
+#include <memory>
+#include <string>
+
+namespace shapes
+{
+class Mesh;
+}
+
+namespace YAML
+{
+class Node;
+}
+
+namespace reach_ros
+{
+namespace collision
+{
+/** @brief Parameters of the simplification of a collision mesh */
+struct MeshDecimation
+{
+  /** @brief Maximum number of triangles of the simplified mesh, or 0 for no limit */
+  std::size_t max_triangles = 0;
+  /** @brief Maximum distance (m) between the original mesh and the simplified mesh, or 0 for no limit */
+  double tolerance = 0.0;
+  /**
+   * @brief Keep the original mesh for collision checks, and only use the simplified mesh as a coarse pre-check, such
+   * that only queries near the simplified mesh are checked against the original mesh
+   */
+  bool coarse_fine = false;
+
+  bool enabled() const;
+};
+
+/**
+ * @brief Parses the optional mesh decimation parameters from a plugin configuration
+ * @details The parameters are a map with the optional keys `max_triangles`, `tolerance`, and `coarse_fine`
+ */
+MeshDecimation getMeshDecimation(const YAML::Node& config, const std::string& key = "collision_mesh_decimation");
+
+/**
+ * @brief Simplifies a mesh into the faces of the cells of a uniform grid that it touches
+ * @details Every point of the original mesh lies in a cell whose faces are all part of the simplified mesh, so it is
+ * within half a cell size of the simplified mesh, and thin features are never lost. Robot links padded by that distance
+ * are therefore free of collision with the original mesh if they are free of collision with the simplified mesh, and
+ * their distance to the simplified mesh is a lower bound of the distance of the unpadded links to the original mesh.
+ * Coplanar faces are merged into rectangles of two triangles each. The cell size is at most twice the tolerance and,
+ * with a maximum triangle count, the smallest that meets it (found by bisection). The original mesh is returned if it
+ * has no more triangles than the simplified mesh
+ * @param error Output maximum distance (m) between any point of the original mesh and the returned mesh (i.e., half the
+ * cell size), by which robot links must be padded for checks against the returned mesh to not be optimistic
+ * @throws std::runtime_error if the maximum triangle count cannot be met within the tolerance
+ */
+std::shared_ptr<const shapes::Mesh> decimateMesh(const shapes::Mesh& mesh, const MeshDecimation& decimation,
+                                                 double& error);
+
+}  // namespace collision
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_COLLISION_MESH_DECIMATION_H
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_COLLISION_SELF_COLLISION_SAMPLING_H
+#define REACH_ROS_COLLISION_SELF_COLLISION_SAMPLING_H
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+class RobotModel;
+typedef std::shared_ptr<const RobotModel> RobotModelConstPtr;
+class JointModelGroup;
+}  // namespace core
+}  // namespace moveit
+
+namespace collision_detection
+{
+class AllowedCollisionMatrix;
+}
+
+namespace reach_ros
+{
+namespace collision
+{
+/** @brief Pairs of robot links whose collision status did not change over randomly sampled configurations */
+struct SampledCollisions
+{
+  std::size_t n_samples = 0;
+  std::vector<std::pair<std::string, std::string>> never_colliding;
+  std::vector<std::pair<std::string, std::string>> always_colliding;
+
+  /** @brief Allows collision between all of the pairs */
+  void apply(collision_detection::AllowedCollisionMatrix& acm) const;
+
+  /** @return The pairs written to a stream by write, or nullptr if the stream does not contain valid pairs */
+  static std::shared_ptr<SampledCollisions> read(std::istream& stream);
+
+  void write(std::ostream& stream) const;
+};
+
+/**
+ * @brief Checks the robot for self-collision in random configurations of a planning group (with the other joints at
+ * their default positions), and returns the pairs of links that never or always collide
+ * @details This is the sampling approach of the MoveIt Setup Assistant. Pairs that are already allowed to collide are
+ * not checked, and are not returned. Pairs that never collided in the samples are assumed to never collide, so the
+ * number of samples should be large (e.g., 10000 or more) relative to the size of the configuration space. The samples
+ * are checked in parallel, and are seeded deterministically
+ */
+SampledCollisions sampleSelfCollisions(const moveit::core::RobotModelConstPtr& model,
+                                       const collision_detection::AllowedCollisionMatrix& acm,
+                                       const moveit::core::JointModelGroup* jmg, std::size_t n_samples,
+                                       std::size_t n_threads);
+
+}  // namespace collision
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_COLLISION_SELF_COLLISION_SAMPLING_H
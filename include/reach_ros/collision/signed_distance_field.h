@@ -0,0 +1,99 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_COLLISION_SIGNED_DISTANCE_FIELD_H
+#define REACH_ROS_COLLISION_SIGNED_DISTANCE_FIELD_H
+
+#include <array>
+#include <cstdint>
+#include <Eigen/Geometry>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+namespace shapes
+{
+class Mesh;
+}
+
+namespace reach_ros
+{
+namespace collision
+{
+/**
+ * @brief Signed distance field of a static mesh, sampled on a uniform grid
+ * @details Distances are positive outside of the mesh and negative inside of it, and saturate at a maximum distance.
+ * The grid values are the exact distances clamped to the maximum distance, which change by at most the distance
+ * between two points, so a trilinear interpolation of the grid values is within the length of a cell diagonal of the
+ * clamped distance. For open meshes, this only holds for the magnitude of the distance (see isClosed)
+ */
+class SignedDistanceField
+{
+public:
+  /** @brief Version of the stream format of read and write, which changes whenever the computed field changes */
+  static const std::uint32_t VERSION;
+
+  /**
+   * @brief Computes the signed distance field of a mesh
+   * @details Distances to the nearest triangle are computed exactly for the grid points within the maximum distance (or
+   * a narrow band, if wider) of each triangle; the other grid points saturate. Grid points in the band take the sign of
+   * their offset along the normal of their nearest triangle; other grid points are outside of the mesh if they can be
+   * reached from the boundary of the grid without crossing the band, and inside of it otherwise. Open meshes therefore
+   * have no inside beyond the band (see isClosed). Vertices much closer than the resolution are merged first, and
+   * triangles that collapse are treated as line segments. The computation time grows with the number of grid points
+   * within the maximum distance of the mesh
+   * @param pose Pose of the mesh in the frame of the field
+   * @param resolution Spacing (m) of the grid
+   * @param max_distance Distance (m) at which distances saturate, by which the grid extends beyond the mesh
+   */
+  SignedDistanceField(const shapes::Mesh& mesh, const Eigen::Isometry3d& pose, double resolution, double max_distance);
+
+  /** @return The field written to a stream by write, or nullptr if the stream does not contain a valid field */
+  static std::shared_ptr<SignedDistanceField> read(std::istream& stream);
+
+  void write(std::ostream& stream) const;
+
+  /** @brief Returns the signed distance (m) of a point (in the frame of the field) from the surface of the mesh */
+  double getDistance(const Eigen::Vector3d& point) const;
+
+  double getResolution() const;
+  double getMaxDistance() const;
+
+  /**
+   * @brief Returns true if the mesh is closed, i.e., every edge is shared by exactly two triangles that traverse it in
+   * opposite directions, such that its inside is well defined
+   * @details The sign of the distance near an open mesh only tells on which side of the nearest triangle a point is
+   */
+  bool isClosed() const;
+
+private:
+  SignedDistanceField() = default;
+
+  std::size_t getIndex(std::size_t i, std::size_t j, std::size_t k) const;
+
+  Eigen::Vector3d origin_;
+  double resolution_;
+  double max_distance_;
+  std::array<std::size_t, 3> size_;
+  bool closed_;
+
+  /** @brief Signed distance of each grid point, with the first axis varying fastest */
+  std::vector<float> values_;
+};
+
+}  // namespace collision
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_COLLISION_SIGNED_DISTANCE_FIELD_H
@@ -16,8 +16,13 @@
 #ifndef REACH_ROS_EVALUATION_DISTANCE_PENALTY_MOVEIT_H
 #define REACH_ROS_EVALUATION_DISTANCE_PENALTY_MOVEIT_H
 
+#include <reach_ros/collision/collision_scope.h>
+#include <reach_ros/collision/mesh_decimation.h>
+
 #include <reach/interfaces/evaluator.h>
+#include <cstdint>
 #include <moveit_msgs/PlanningScene.h>
+#include <set>
 
 namespace moveit
 {
@@ -26,9 +31,16 @@ namespace core
 class RobotModel;
 typedef std::shared_ptr<const RobotModel> RobotModelConstPtr;
 class JointModelGroup;
+class LinkModel;
 }  // namespace core
 }  // namespace moveit
 
+namespace collision_detection
+{
+class CollisionEnv;
+typedef std::shared_ptr<const CollisionEnv> CollisionEnvConstPtr;
+}  // namespace collision_detection
+
 namespace planning_scene
 {
 class PlanningScene;
@@ -37,6 +49,12 @@ typedef std::shared_ptr<PlanningScene> PlanningScenePtr;
 
 namespace reach_ros
 {
+namespace collision
+{
+class LinkSpheres;
+class SignedDistanceField;
+}  // namespace collision
+
 namespace evaluation
 {
 class DistancePenaltyMoveIt : public reach::Evaluator
@@ -44,10 +62,46 @@ class DistancePenaltyMoveIt : public reach::Evaluator
 public:
   DistancePenaltyMoveIt(moveit::core::RobotModelConstPtr model, const std::string& planning_group,
                         const double dist_threshold, int exponent, std::string collision_mesh_filename,
-                        std::vector<std::string> touch_links);
+                        std::vector<std::string> touch_links, const collision::MeshDecimation& decimation = {});
   double calculateScore(const std::map<std::string, double>& pose) const override;
 
+  /**
+   * @brief Scores poses by the distance between spheres enclosing the robot links and the collision mesh, looked up in
+   * a precomputed signed distance field of the collision mesh, rather than by the exact distance
+   * @details Distances saturate at the maximum distance of the field, which is raised to at least the distance
+   * threshold plus two grid cells
+   */
+  void setSignedDistanceField(double resolution, double max_distance);
+
+  /**
+   * @brief Allows collision between the pairs of robot links that never or always collide in random configurations of
+   * the planning group (see utils::getSampledSelfCollisions)
+   */
+  void setSelfCollisionSampling(std::size_t n_samples);
+
+  /**
+   * @brief Sets the collision environments to which the distance is computed: the collision mesh (the default), the
+   * robot itself, or the minimum of both
+   */
+  void setCollisionScope(collision::CollisionScope scope);
+
+  /**
+   * @brief Sets the links whose distance to the collision mesh is scored, or an empty list for all links
+   * @details The distance to the robot itself (see setCollisionScope) is still computed for all links
+   */
+  void setClearanceLinks(const std::vector<std::string>& clearance_links);
+
+  /**
+   * @brief Sets the distance beyond which all poses receive the same score, or a non-positive value for no limit
+   * @details Distance queries are bounded by this distance, such that pairs of links and collision geometry whose
+   * bounding volumes are farther apart are pruned rather than measured exactly
+   */
+  void setMaxRelevantDistance(double max_relevant_distance);
+
 private:
+  /** @brief Re-creates the spheres enclosing the clearance links (other than the touch links) */
+  void updateLinkSpheres();
+
   moveit::core::RobotModelConstPtr model_;
   const moveit::core::JointModelGroup* jmg_;
   const double dist_threshold_;
@@ -56,6 +110,21 @@ private:
   const std::vector<std::string> touch_links_;
 
   planning_scene::PlanningScenePtr scene_;
+  /**
+   * @brief Collision environment of the robot and the collision mesh, with the links padded by the error of the mesh
+   * if it is simplified (see collision::decimateMesh), or else the collision environment of the planning scene
+   */
+  collision_detection::CollisionEnvConstPtr world_env_;
+  collision::CollisionScope collision_scope_;
+  std::set<const moveit::core::LinkModel*> clearance_links_;
+  double max_relevant_distance_;
+  /**
+   * @brief Key of the distance query to the collision mesh (see utils::getDistanceQueryKey), with which distances
+   * already computed by the clearance check of an IK solver on the same collision world are reused
+   */
+  std::uint64_t distance_query_key_;
+  std::shared_ptr<const collision::SignedDistanceField> sdf_;
+  std::shared_ptr<const collision::LinkSpheres> link_spheres_;
 };
 
 struct DistancePenaltyMoveItFactory : public reach::EvaluatorFactory
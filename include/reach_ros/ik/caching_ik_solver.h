@@ -0,0 +1,99 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_IK_CACHING_IK_SOLVER_H
+#define REACH_ROS_IK_CACHING_IK_SOLVER_H
+
+#include <reach_ros/ik/kinematics_hash.h>
+
+#include <reach/interfaces/ik_solver.h>
+#include <array>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace reach_ros
+{
+namespace ik
+{
+/**
+ * @brief IK solver decorator that serves repeated requests (i.e., the same target and seed, to within configurable
+ * tolerances) from a bounded least-recently-used cache rather than re-solving them with the wrapped IK solver
+ * @details The cache is split into independently locked shards, each of which holds an equal share of the memory limit
+ */
+class CachingIKSolver : public reach::IKSolver, public KinematicsHashProvider
+{
+public:
+  /**
+   * @param position_tolerance Resolution (m) to which the target position is quantized
+   * @param orientation_tolerance Resolution to which the components of the target orientation quaternion are quantized
+   * @param joint_tolerance Resolution (rad or m) to which the seed joint positions are quantized
+   * @param max_memory Approximate maximum size (bytes) of the cache
+   */
+  CachingIKSolver(reach::IKSolver::ConstPtr ik_solver, double position_tolerance, double orientation_tolerance,
+                  double joint_tolerance, std::size_t max_memory);
+  ~CachingIKSolver();
+
+  std::vector<std::vector<double>> solveIK(const Eigen::Isometry3d& target,
+                                           const std::map<std::string, double>& seed) const override;
+  std::vector<std::string> getJointNames() const override;
+
+  /** @brief Returns the kinematics hash of the wrapped IK solver */
+  std::uint64_t getKinematicsHash() const override;
+
+protected:
+  using Key = std::vector<long long>;
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Shard
+  {
+    std::mutex mutex;
+    std::size_t memory = 0;
+
+    /** @brief Entries in order of most to least recently used */
+    std::list<std::pair<Key, std::vector<std::vector<double>>>> entries;
+    std::unordered_map<Key, decltype(entries)::iterator, KeyHash> index;
+  };
+
+  Key getKey(const Eigen::Isometry3d& target, const std::map<std::string, double>& seed) const;
+
+  /** @brief Returns the approximate memory used by a cache entry */
+  static std::size_t getMemory(const Key& key, const std::vector<std::vector<double>>& solutions);
+
+  reach::IKSolver::ConstPtr ik_solver_;
+  const double position_tolerance_;
+  const double orientation_tolerance_;
+  const double joint_tolerance_;
+  const std::size_t max_shard_memory_;
+
+  mutable std::array<Shard, 16> shards_;
+  mutable std::atomic<std::size_t> n_hits_;
+  mutable std::atomic<std::size_t> n_misses_;
+};
+
+struct CachingIKSolverFactory : public reach::IKSolverFactory
+{
+  reach::IKSolver::ConstPtr create(const YAML::Node& config) const override;
+};
+
+}  // namespace ik
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_IK_CACHING_IK_SOLVER_H
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_IK_CAPABILITY_MAP_H
+#define REACH_ROS_IK_CAPABILITY_MAP_H
+
+#include <Eigen/Geometry>
+#include <array>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace reach_ros
+{
+namespace ik
+{
+/**
+ * @brief Read-only, memory-mapped map of the fraction of poses reachable by a planning group, indexed by position voxel
+ * and by bin of the direction of the tool Z-axis
+ * @details Directions are binned on the faces of a cube, each of which is divided into a square grid, which gives
+ * bins of similar solid angle. The rotation about the tool Z-axis is not binned, since reach study targets are usually
+ * evaluated over all rotations about it.
+ *
+ * The file consists of a fixed-size header followed by one byte per voxel and bin, holding the reachable fraction
+ * scaled to [0, 255]. The header records the grid and a hash of the kinematics (robot model, planning group, and
+ * kinematic base and tip frames) for which the map was built. Values are stored in the native byte order of the
+ * machine that built the map
+ */
+class CapabilityMap
+{
+public:
+  /** @brief Layout of the position voxels and direction bins of a capability map */
+  struct Grid
+  {
+    /** @brief Position (m, in the robot model frame) of the minimum corner of the voxel grid */
+    Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+    /** @brief Edge length (m) of the voxels */
+    double resolution = 0.0;
+    /** @brief Number of voxels along each axis */
+    std::array<std::uint32_t, 3> size{ { 0, 0, 0 } };
+    /** @brief Number of divisions of each edge of each cube face into which directions are binned */
+    std::uint32_t n_direction_divisions = 0;
+
+    std::size_t getNumVoxels() const;
+    std::size_t getNumBins() const;
+    Eigen::Vector3d getVoxelCenter(std::size_t voxel) const;
+
+    /** @return False if the position lies outside of the voxel grid, true otherwise */
+    bool getVoxel(const Eigen::Vector3d& position, std::size_t& voxel) const;
+    std::size_t getBin(const Eigen::Vector3d& direction) const;
+
+    /** @brief Samples a unit direction uniformly over the face region of a bin */
+    Eigen::Vector3d sampleBinDirection(std::size_t bin, std::mt19937& rng) const;
+  };
+
+  /** @brief Memory-maps a capability map file */
+  explicit CapabilityMap(const std::string& filename);
+
+  /**
+   * @brief Writes a capability map file
+   * @param kinematics_hash Hash of the kinematics for which the map was built (see KinematicsHashProvider)
+   * @param reachability Reachable fraction (scaled to [0, 255]) of each voxel and bin, indexed by voxel * n_bins + bin
+   */
+  static void save(const std::string& filename, const Grid& grid, std::uint64_t kinematics_hash,
+                   const std::vector<std::uint8_t>& reachability);
+
+  /**
+   * @brief Returns the reachable fraction [0, 1] of the voxel and direction bin of the input pose (in the robot model
+   * frame), or a negative value if the pose lies outside of the voxel grid
+   */
+  double getReachability(const Eigen::Isometry3d& pose) const;
+
+  /**
+   * @brief Returns the maximum reachable fraction [0, 1] of the voxel and direction bin of the input pose (in the robot
+   * model frame) and of their neighbors, or a negative value if any of the neighboring voxels lies outside of the voxel
+   * grid
+   * @details The neighbors are the 26 voxels adjacent to the voxel of the pose and the bins of the directions one bin
+   * width away from the tool Z-axis (including bins on adjacent cube faces). A bin whose samples were all unreachable
+   * may still contain reachable poses, but a whole neighborhood of such bins is much stronger evidence
+   */
+  double getNeighborhoodReachability(const Eigen::Isometry3d& pose) const;
+
+  const Grid& getGrid() const;
+  std::uint64_t getKinematicsHash() const;
+
+private:
+  Grid grid_;
+  std::uint64_t kinematics_hash_;
+  boost::interprocess::file_mapping file_;
+  boost::interprocess::mapped_region region_;
+  const std::uint8_t* data_;
+};
+
+}  // namespace ik
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_IK_CAPABILITY_MAP_H
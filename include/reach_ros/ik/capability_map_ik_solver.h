@@ -0,0 +1,71 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_IK_CAPABILITY_MAP_IK_SOLVER_H
+#define REACH_ROS_IK_CAPABILITY_MAP_IK_SOLVER_H
+
+#include <reach_ros/ik/capability_map.h>
+#include <reach_ros/ik/kinematics_hash.h>
+
+#include <reach/interfaces/ik_solver.h>
+#include <atomic>
+
+namespace reach_ros
+{
+namespace ik
+{
+/**
+ * @brief IK solver wrapper that rejects targets whose capability map bin is known to be unreachable without calling the
+ * wrapped IK solver
+ * @details A target is only rejected if its bin and the neighboring bins and voxels are all unreachable (see
+ * CapabilityMap::getNeighborhoodReachability). Targets near or outside of the boundary of the voxel grid of the
+ * capability map are always passed to the wrapped IK solver
+ */
+class CapabilityMapIKSolver : public reach::IKSolver, public KinematicsHashProvider
+{
+public:
+  /**
+   * @param min_reachable_fraction Targets whose bin and neighboring bins all have a reachable fraction less than or
+   * equal to this value are rejected
+   */
+  CapabilityMapIKSolver(reach::IKSolver::ConstPtr ik_solver, const std::string& capability_map_filename,
+                        double min_reachable_fraction);
+  ~CapabilityMapIKSolver();
+
+  std::vector<std::vector<double>> solveIK(const Eigen::Isometry3d& target,
+                                           const std::map<std::string, double>& seed) const override;
+  std::vector<std::string> getJointNames() const override;
+
+  /** @brief Returns the kinematics hash of the wrapped IK solver */
+  std::uint64_t getKinematicsHash() const override;
+
+protected:
+  reach::IKSolver::ConstPtr ik_solver_;
+  const CapabilityMap map_;
+  const double min_reachable_fraction_;
+
+  mutable std::atomic<std::size_t> n_rejected_;
+  mutable std::atomic<std::size_t> n_passed_;
+};
+
+struct CapabilityMapIKSolverFactory : public reach::IKSolverFactory
+{
+  reach::IKSolver::ConstPtr create(const YAML::Node& config) const override;
+};
+
+}  // namespace ik
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_IK_CAPABILITY_MAP_IK_SOLVER_H
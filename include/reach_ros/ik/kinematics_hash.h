@@ -0,0 +1,50 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_IK_KINEMATICS_HASH_H
+#define REACH_ROS_IK_KINEMATICS_HASH_H
+
+#include <reach/interfaces/ik_solver.h>
+#include <cstdint>
+
+namespace reach_ros
+{
+namespace ik
+{
+/**
+ * @brief Interface of IK solvers that can identify the kinematics with which they solve IK, against which offline data
+ * (e.g., a capability map) can be checked
+ * @details Implemented by the MoveIt IK solvers, and by the IK solver wrappers of this package by forwarding to the IK
+ * solver they wrap
+ */
+class KinematicsHashProvider
+{
+public:
+  virtual ~KinematicsHashProvider() = default;
+
+  /** @brief Returns a hash that identifies the kinematics of the IK solver */
+  virtual std::uint64_t getKinematicsHash() const = 0;
+};
+
+/**
+ * @brief Returns the kinematics hash of an IK solver (see KinematicsHashProvider)
+ * @throws std::runtime_error if the IK solver, or an IK solver it wraps, does not implement KinematicsHashProvider
+ */
+std::uint64_t getKinematicsHash(const reach::IKSolver& ik_solver);
+
+}  // namespace ik
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_IK_KINEMATICS_HASH_H
@@ -16,8 +16,19 @@
 #ifndef REACH_ROS_IK_MOVEIT_IK_SOLVER_H
 #define REACH_ROS_IK_MOVEIT_IK_SOLVER_H
 
+#include <reach_ros/collision/clearance_mode.h>
+#include <reach_ros/collision/collision_scope.h>
+#include <reach_ros/collision/mesh_decimation.h>
+#include <reach_ros/ik/kinematics_hash.h>
+
 #include <reach/interfaces/ik_solver.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
 #include <ros/publisher.h>
+#include <thread>
 #include <vector>
 
 namespace moveit
@@ -27,10 +38,22 @@ namespace core
 class RobotModel;
 typedef std::shared_ptr<const RobotModel> RobotModelConstPtr;
 class JointModelGroup;
+class LinkModel;
 class RobotState;
 }  // namespace core
 }  // namespace moveit
 
+namespace collision_detection
+{
+class CollisionEnv;
+typedef std::shared_ptr<CollisionEnv> CollisionEnvPtr;
+typedef std::shared_ptr<const CollisionEnv> CollisionEnvConstPtr;
+class World;
+typedef std::shared_ptr<World> WorldPtr;
+class AllowedCollisionMatrix;
+typedef std::shared_ptr<const AllowedCollisionMatrix> AllowedCollisionMatrixConstPtr;
+}  // namespace collision_detection
+
 namespace planning_scene
 {
 class PlanningScene;
@@ -39,12 +62,42 @@ typedef std::shared_ptr<PlanningScene> PlanningScenePtr;
 
 namespace reach_ros
 {
+namespace collision
+{
+class CollisionPrecheck;
+class LinkSpheres;
+class SignedDistanceField;
+}  // namespace collision
+
 namespace ik
 {
-class MoveItIKSolver : public reach::IKSolver
+class SeedCache;
+
+class MoveItIKSolver : public reach::IKSolver, public KinematicsHashProvider
 {
 public:
+  /** @brief Method by which the distance threshold is enforced */
+  using ClearanceMode = collision::ClearanceMode;
+
+  /**
+   * @brief Number of IK solutions checked for validity, and the number rejected by each stage of the check, plus the
+   * number of targets rejected by the workspace envelope without solving IK and the decisions of the collision
+   * pre-check
+   */
+  struct ValidityStatistics
+  {
+    std::size_t checked = 0;
+    std::size_t joint_limit_rejections = 0;
+    std::size_t collision_rejections = 0;
+    std::size_t clearance_rejections = 0;
+    std::size_t envelope_rejections = 0;
+    /** @brief Number of checked solutions decided free of (or in) collision with the mesh by the collision pre-check */
+    std::size_t precheck_free = 0;
+    std::size_t precheck_colliding = 0;
+  };
+
   MoveItIKSolver(moveit::core::RobotModelConstPtr model, const std::string& planning_group, double dist_threshold);
+  ~MoveItIKSolver();
 
   std::vector<std::vector<double>> solveIK(const Eigen::Isometry3d& target,
                                            const std::map<std::string, double>& seed) const override;
@@ -52,20 +105,244 @@ public:
   std::vector<std::string> getJointNames() const override;
 
   void setTouchLinks(const std::vector<std::string>& touch_links);
-  void addCollisionMesh(const std::string& collision_mesh_filename, const std::string& collision_mesh_frame);
+  void setClearanceMode(ClearanceMode mode);
+
+  /**
+   * @brief Sets the collision environments against which solutions are checked for collision
+   * @details The clearance check (against the collision mesh) is skipped if the scope does not include the collision
+   * world
+   */
+  void setCollisionScope(collision::CollisionScope scope);
+
+  /**
+   * @brief Sets the links whose distance to the collision mesh is checked against the distance threshold, or an empty
+   * list for all links
+   * @details Links that rarely come near the collision mesh (e.g., the base and shoulder) can be left out to reduce the
+   * cost of the clearance check; they are still checked for collision
+   */
+  void setClearanceLinks(const std::vector<std::string>& clearance_links);
+
+  /**
+   * @brief Sets the maximum number of distinct solutions returned per target
+   * @details Solutions whose joint positions all lie within the solution tolerance of an existing solution are merged
+   * into it
+   */
+  void setMaxSolutions(std::size_t max_solutions, double solution_tolerance);
+
+  /**
+   * @brief Sets the number of random seeds from which the solver is run (after the input seed and the seed states)
+   * until enough solutions have been found
+   */
+  void setNumRandomSeeds(std::size_t n_random_seeds);
+
+  /**
+   * @brief Sets the named states (defined in the SRDF) from which the solver is run (after the input seed) until enough
+   * solutions have been found
+   */
+  void setSeedStates(const std::vector<std::string>& seed_states);
+
+  /**
+   * @brief Sets the maximum number of threads (including the calling thread) across which the seeds are solved
+   * @details Once enough solutions have been found, seeds that have not yet been solved are skipped and solves in
+   * progress are cancelled
+   */
+  void setNumSeedThreads(std::size_t n_seed_threads);
+
+  /**
+   * @brief Enables a cache of recently solved targets, from whose solutions the solver is run (before the input seed)
+   * for nearby targets
+   * @param resolution Edge length (m) of the voxels in which the cached targets are indexed; a non-positive value
+   * disables the cache
+   * @param n_neighbors Maximum number of cached solutions tried per target
+   */
+  void setSeedCache(double resolution, std::size_t n_neighbors);
+
+  /**
+   * @brief Enables rejection of targets outside of the workspace envelope of the planning group before solving IK
+   * @details The envelope is a conservative sphere about the parent link of the first active joint, whose radius is the
+   * sum of the link lengths and prismatic joint extents between that link and the tip link of the kinematics solver.
+   * It is unavailable (and this setting has no effect) for planning groups with unbounded or multi-DOF joints
+   */
+  void setWorkspaceEnvelope(bool use_workspace_envelope);
+
+  /**
+   * @brief Sets the grid resolution and saturation distance of the signed distance field of the collision mesh, for the
+   * signed distance field clearance mode
+   * @details The clearance error is on the order of the resolution, plus the amount by which the spheres enclosing the
+   * links exceed the link geometry. The saturation distance is raised to at least the distance threshold plus two grid
+   * cells
+   */
+  void setSignedDistanceField(double resolution, double max_distance);
+
+  /**
+   * @brief Enables a pre-check of collision with the collision mesh using spheres enclosing the robot links and the
+   * signed distance field of the collision mesh
+   * @details States whose link spheres are clear of the mesh are only checked for self-collision, and states with a
+   * link edge that clearly crosses the mesh surface are rejected without an exact check. Only the remaining states are
+   * checked exactly. The pre-check uses the signed distance field of the full mesh, which must be closed
+   */
+  void setCollisionPrecheck(bool use_collision_precheck);
+
+  /**
+   * @brief Allows collision between the pairs of robot links that never or always collide in random configurations of
+   * the planning group, such that they are skipped by the self-collision check
+   * @details The sampled pairs are cached on disk (see utils::getSampledSelfCollisions). Pairs that never collided in
+   * the samples are assumed to never collide, so the number of samples should be large (e.g., 10000 or more)
+   */
+  void setSelfCollisionSampling(std::size_t n_samples);
+
+  /**
+   * @brief Adds the collision mesh of the workpiece, optionally simplified
+   * @details The links are padded by the error of the simplified mesh in all checks against it, such that they are
+   * not optimistic. If the decimation uses a coarse/fine pair, the original mesh is used for collision checks, and the
+   * simplified mesh is used to accept states that are clearly free of collision without checking the original mesh
+   */
+  void addCollisionMesh(const std::string& collision_mesh_filename, const std::string& collision_mesh_frame,
+                        const collision::MeshDecimation& decimation = {});
   std::string getKinematicBaseFrame() const;
 
+  /**
+   * @brief Returns a hash of the names of the robot model and planning group and of the base and tip frames of the
+   * kinematics solver, which identifies the kinematics for which offline data (e.g., a capability map) was built
+   */
+  std::uint64_t getKinematicsHash() const override;
+
+  ValidityStatistics getValidityStatistics() const;
+
 protected:
-  bool isIKSolutionValid(moveit::core::RobotState* state, const moveit::core::JointModelGroup* jmg,
+  /**
+   * @brief Scratch data used by a single thread to solve IK, such that it can be re-used rather than re-allocated for
+   * every solve
+   */
+  struct Context;
+
+  /** @brief Returns the context of the calling thread, creating it if it does not yet exist */
+  Context& getContext() const;
+
+  /**
+   * @brief Solves IK for a target (in the model frame) from a seed of the planning group joints, using the kinematics
+   * solver instance of the input context
+   * @param cancel Optional flag with which another thread can cancel the solve
+   * @return True if a valid solution was found, false otherwise (including if the solve was cancelled)
+   */
+  bool searchIK(Context& ctx, const Eigen::Isometry3d& target, const std::vector<double>& seed,
+                std::vector<double>& solution, const std::atomic<bool>* cancel = nullptr) const;
+
+  /**
+   * @brief Appends all valid solutions returned by a single multi-solution query of the kinematics solver
+   * @return False if the kinematics solver does not support multi-solution queries, true otherwise
+   */
+  bool searchAllIK(Context& ctx, const Eigen::Isometry3d& target, const std::vector<double>& seed,
+                   std::vector<std::vector<double>>& solutions) const;
+
+  /**
+   * @brief Checks the validity of an IK solution in stages of increasing cost, returning as soon as one stage rejects
+   * the solution
+   * @details The stages are: joint limits, collision, and (if the distance threshold is positive) distance to collision
+   */
+  bool isIKSolutionValid(Context& ctx, moveit::core::RobotState* state, const moveit::core::JointModelGroup* jmg,
                          const double* ik_solution) const;
 
+  /**
+   * @brief Checks a state for collision with the robot itself and/or the collision mesh (per the collision scope),
+   * using the collision pre-check and the coarse collision mesh (if any) to skip checks against the full collision mesh
+   */
+  bool isStateColliding(Context& ctx, const moveit::core::RobotState& state,
+                        const moveit::core::JointModelGroup* jmg) const;
+
+  /**
+   * @brief Re-creates the signed distance field of the collision mesh, the link spheres, and the collision pre-check
+   * for the current collision mesh, touch links, and settings
+   */
+  void updateSignedDistanceField();
+
+  /**
+   * @brief Checks whether a target (in the model frame) could be within reach of the planning group, counting the
+   * targets that are not
+   */
+  bool isWithinWorkspaceEnvelope(const Eigen::Isometry3d& target) const;
+
   moveit::core::RobotModelConstPtr model_;
   const moveit::core::JointModelGroup* jmg_;
   const double distance_threshold_;
 
   planning_scene::PlanningScenePtr scene_;
+  ClearanceMode clearance_mode_;
+  collision::CollisionScope collision_scope_;
+  /** @brief Links whose clearance is checked, or an empty set for all links */
+  std::set<const moveit::core::LinkModel*> clearance_links_;
+  /**
+   * @brief Key of the clearance distance query (see utils::getDistanceQueryKey), with which distances computed by the
+   * clearance check are memoized for the distance penalty evaluator
+   */
+  std::uint64_t distance_query_key_;
+
+  /**
+   * @brief Maximum distance between the original collision mesh and the mesh of the planning scene if it is simplified
+   * (see collision::decimateMesh), or 0, and the simplification of the mesh of the planning scene
+   */
+  double mesh_error_;
+  collision::MeshDecimation scene_decimation_;
+  /**
+   * @brief Collision environment of the robot and the collision mesh, with the links padded by the error of the mesh
+   * if it is simplified, or else the collision environment of the planning scene
+   */
+  collision_detection::CollisionEnvConstPtr world_env_;
+
+  /**
+   * @brief Collision environment with robot links padded by the distance threshold (and the error of the mesh), for the
+   * padding clearance mode
+   */
+  collision_detection::CollisionEnvPtr padded_env_;
+
+  /**
+   * @brief Simplified collision mesh and its error, with which states clearly free of collision are accepted without
+   * checking the full collision mesh, and its collision environments with links padded by the error, and by the error
+   * and the distance threshold
+   */
+  collision_detection::WorldPtr coarse_world_;
+  double coarse_error_;
+  collision_detection::CollisionEnvPtr coarse_env_;
+  collision_detection::CollisionEnvPtr coarse_padded_env_;
+
+  std::string collision_mesh_filename_;
+  std::string collision_mesh_frame_;
+
+  /** @brief Signed distance field of the collision mesh and spheres enclosing the links, for the SDF clearance mode */
+  double sdf_resolution_;
+  double sdf_max_distance_;
+  std::shared_ptr<const collision::SignedDistanceField> sdf_;
+  std::shared_ptr<const collision::LinkSpheres> link_spheres_;
+  bool use_collision_precheck_;
+  /** @brief Pre-check of the collision with the mesh of the planning scene (which may be simplified) */
+  std::shared_ptr<const collision::CollisionPrecheck> collision_precheck_;
+
+  /**
+   * @brief Allowed collision matrix of the planning scene with the collisions with the collision mesh allowed, with
+   * which states that the pre-check or the coarse mesh decide to be free of collision with the mesh are still checked
+   * against the other objects of the world
+   */
+  collision_detection::AllowedCollisionMatrixConstPtr other_objects_acm_;
+
+  std::size_t max_solutions_;
+  double solution_tolerance_;
+  std::size_t n_random_seeds_;
+  std::vector<std::vector<double>> seed_states_;
+  std::size_t n_seed_threads_;
+  std::shared_ptr<SeedCache> seed_cache_;
+  std::size_t n_seed_cache_neighbors_;
+
+  bool use_workspace_envelope_;
+  Eigen::Vector3d envelope_center_;
+  /** @brief Radius of the workspace envelope, or a negative value if the envelope is unavailable */
+  double envelope_radius_;
+  mutable std::atomic<std::size_t> n_envelope_rejections_;
+
   ros::Publisher scene_pub_;
 
+  mutable std::mutex context_mutex_;
+  mutable std::map<std::thread::id, std::shared_ptr<Context>> contexts_;
+
   static std::string COLLISION_OBJECT_NAME;
 };
 
@@ -83,8 +360,62 @@ public:
   std::vector<std::vector<double>> solveIK(const Eigen::Isometry3d& target,
                                            const std::map<std::string, double>& seed) const override;
 
+  /**
+   * @brief Sets the maximum number of threads (including the calling thread) with which the discretized targets are
+   * solved
+   */
+  void setNumThreads(std::size_t n_threads);
+
+  /**
+   * @brief Sets the number of feasible discretizations after which the solver stops solving the remaining
+   * discretizations of a target; zero solves all discretizations
+   */
+  void setMaxDiscretizedSolutions(std::size_t max_solutions);
+
+  /**
+   * @brief Enables continuation seeding, in which the discretizations are solved in order of angle and each is seeded
+   * with the solution of the previous discretization (or the original seed if the previous discretization failed)
+   * @details When solved with multiple threads, the discretizations are split into one contiguous range of angles per
+   * thread, each of which is swept with continuation seeding
+   */
+  void setContinuation(bool continuation);
+
+  /**
+   * @brief Enables the wrist-axis shortcut, if the kinematic structure of the planning group supports it
+   * @details If the last active joint of the planning group is a revolute joint coaxial with the Z-axis of the tip
+   * link, rotating the target about its Z-axis only changes the position of that joint by the same angle. In this case,
+   * IK is solved fully for only one discretization; the solutions of the other discretizations are generated by
+   * offsetting the last joint, such that only the validity of the solution needs to be checked. Discretizations whose
+   * offset solution would exceed the joint limits or is invalid fall back to full IK. Disabled by default
+   */
+  void setWristAxisShortcut(bool wrist_axis_shortcut);
+
+  /**
+   * @brief Enables adaptive (coarse-to-fine) discretization
+   * @details The discretizations are first sampled at the coarse angle. The intervals between adjacent samples whose
+   * feasibility differs are then bisected, seeding each new sample with the solution of the feasible end of its
+   * interval, until the discretization angle is reached. Intervals whose ends are both feasible or both infeasible are
+   * not refined, so a range of angles that is entirely feasible only returns the solutions of its coarse samples.
+   * Takes precedence over continuation seeding; the wrist-axis shortcut takes precedence over both when the planning
+   * group supports it
+   */
+  void setAdaptive(bool adaptive, double coarse_dt = M_PI / 4.0);
+
 protected:
   const double dt_;
+  const int n_discretizations_;
+  std::size_t n_threads_;
+  std::size_t max_discretized_solutions_;
+  bool continuation_;
+  bool adaptive_;
+  double coarse_dt_;
+
+  /**
+   * @brief Direction of the last active joint axis relative to the Z-axis of the tip link (+1 or -1), or 0 if the axes
+   * are not coaxial
+   */
+  const int wrist_axis_sign_;
+  bool wrist_axis_shortcut_;
 };
 
 struct DiscretizedMoveItIKSolverFactory : public reach::IKSolverFactory
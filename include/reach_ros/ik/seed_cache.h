@@ -0,0 +1,84 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_IK_SEED_CACHE_H
+#define REACH_ROS_IK_SEED_CACHE_H
+
+#include <Eigen/Geometry>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace reach_ros
+{
+namespace ik
+{
+/**
+ * @brief Thread-safe spatial index of recently solved target poses and their joint solutions, used to warm-start the
+ * IK solver for nearby targets
+ * @details Target poses are hashed into cubic voxels of the given resolution; each voxel retains only its most recent
+ * entries. The voxels are distributed across a fixed number of independently locked shards, such that concurrent
+ * insertions and queries rarely contend
+ */
+class SeedCache
+{
+public:
+  SeedCache(double resolution, std::size_t max_entries_per_voxel = 4);
+
+  /**
+   * @brief Returns the solutions of up to n cached targets nearest to the input target (searching the voxel of the
+   * target and its adjacent voxels), ordered from nearest to farthest
+   * @details The distance between two poses is the distance between their positions plus the angle between their
+   * orientations scaled by the voxel resolution
+   */
+  std::vector<std::vector<double>> getSeeds(const Eigen::Isometry3d& target, std::size_t n) const;
+
+  void insert(const Eigen::Isometry3d& target, const std::vector<double>& solution);
+
+private:
+  using Key = std::array<long, 3>;
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Entry
+  {
+    Eigen::Vector3d position;
+    Eigen::Matrix3d orientation;
+    std::vector<double> solution;
+  };
+
+  struct Shard
+  {
+    mutable std::mutex mutex;
+    std::unordered_map<Key, std::deque<Entry>, KeyHash> voxels;
+  };
+
+  Key getKey(const Eigen::Vector3d& position) const;
+  Shard& getShard(const Key& key) const;
+
+  const double resolution_;
+  const std::size_t max_entries_per_voxel_;
+  mutable std::array<Shard, 64> shards_;
+};
+
+}  // namespace ik
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_IK_SEED_CACHE_H
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REACH_ROS_IK_WAVEFRONT_IK_SOLVER_H
+#define REACH_ROS_IK_WAVEFRONT_IK_SOLVER_H
+
+#include <reach_ros/ik/kinematics_hash.h>
+
+#include <reach/interfaces/ik_solver.h>
+#include <reach/interfaces/target_pose_generator.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace reach_ros
+{
+namespace ik
+{
+/**
+ * @brief IK solver wrapper that solves the full set of reach study targets in a wavefront, seeding each target with the
+ * solution of an already-solved neighbor rather than solving every target from the same seed
+ * @details The first request starts the propagation in the background: a small set of spread-out anchor targets is
+ * solved from the input seed, and the solve then propagates outward through the neighbor graph of the targets one
+ * frontier at a time, with the targets of each frontier solved in parallel. Targets that fail from the solution of a
+ * neighbor are retried from the input seed. Requests for a target wait only until its frontier has been solved, and
+ * the first request for each target is served from the result of the propagation, whether it succeeded or failed. Any
+ * later request (e.g., during the reach study optimization) is passed to the wrapped IK solver with its own seed
+ */
+class WavefrontIKSolver : public reach::IKSolver, public KinematicsHashProvider
+{
+public:
+  /**
+   * @param targets Target poses of the reach study, as generated by its target pose generator
+   * @param neighbor_radius Distance (m) within which targets are considered neighbors
+   * @param n_anchors Number of anchor targets from which the solve propagates
+   * @param n_threads Maximum number of threads across which the targets of each frontier are solved
+   */
+  WavefrontIKSolver(reach::IKSolver::ConstPtr ik_solver, reach::VectorIsometry3d targets, double neighbor_radius,
+                    std::size_t n_anchors, std::size_t n_threads);
+  ~WavefrontIKSolver() override;
+
+  std::vector<std::vector<double>> solveIK(const Eigen::Isometry3d& target,
+                                           const std::map<std::string, double>& seed) const override;
+  std::vector<std::string> getJointNames() const override;
+
+  /** @brief Returns the kinematics hash of the wrapped IK solver */
+  std::uint64_t getKinematicsHash() const override;
+
+protected:
+  using Key = std::array<long long, 7>;
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  /**
+   * @brief Solves all targets, propagating outward from the anchor targets solved from the input seed, and marks the
+   * targets of each frontier as resolved once it has been solved
+   */
+  void propagate(const std::map<std::string, double>& seed) const;
+
+  /** @brief Returns the indices of the targets within the neighbor radius of each target */
+  std::vector<std::vector<std::size_t>> getNeighbors() const;
+
+  /**
+   * @brief Selects spread-out anchor targets by farthest point sampling, starting from the target nearest to the
+   * centroid of the targets
+   */
+  std::vector<std::size_t> getAnchors() const;
+
+  static Key getKey(const Eigen::Isometry3d& target);
+
+  reach::IKSolver::ConstPtr ik_solver_;
+  const reach::VectorIsometry3d targets_;
+  const double neighbor_radius_;
+  const std::size_t n_anchors_;
+  const std::size_t n_threads_;
+
+  /** @brief Map from target pose to target index */
+  std::unordered_map<Key, std::size_t, KeyHash> index_;
+
+  /** @brief Thread running the propagation, started by the first request */
+  mutable std::once_flag started_;
+  mutable std::thread propagation_;
+  mutable std::atomic<bool> stop_;
+
+  /** @brief Solutions of the propagation, of which those of a target are final once the target is resolved */
+  mutable std::vector<std::vector<std::vector<double>>> solutions_;
+
+  /**
+   * @brief Flags indicating whether the propagation has solved (or failed to solve) each target, whether the propagated
+   * solutions of each target have already been returned, and the error that stopped the propagation, if any
+   */
+  mutable std::vector<char> resolved_;
+  mutable std::vector<char> served_;
+  mutable std::exception_ptr error_;
+  mutable std::mutex mutex_;
+  mutable std::condition_variable resolved_cv_;
+};
+
+struct WavefrontIKSolverFactory : public reach::IKSolverFactory
+{
+  reach::IKSolver::ConstPtr create(const YAML::Node& config) const override;
+};
+
+}  // namespace ik
+}  // namespace reach_ros
+
+#endif  // REACH_ROS_IK_WAVEFRONT_IK_SOLVER_H
@@ -16,15 +16,68 @@
 #ifndef REACH_ROS_KINEMATICS_UTILS_H
 #define REACH_ROS_KINEMATICS_UTILS_H
 
+#include <reach_ros/collision/mesh_decimation.h>
+
 #include <Eigen/Dense>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <limits>
+#include <memory>
+#include <set>
 #include <string>
 #include <moveit_msgs/CollisionObject.h>
 #include <visualization_msgs/Marker.h>
 #include <visualization_msgs/InteractiveMarker.h>
 
+namespace YAML
+{
+class Node;
+}
+
+namespace moveit
+{
+namespace core
+{
+class LinkModel;
+class RobotModel;
+typedef std::shared_ptr<const RobotModel> RobotModelConstPtr;
+class RobotState;
+}  // namespace core
+}  // namespace moveit
+
+namespace shapes
+{
+class Mesh;
+}
+
+namespace collision_detection
+{
+class AllowedCollisionMatrix;
+class CollisionEnv;
+class World;
+typedef std::shared_ptr<World> WorldPtr;
+}  // namespace collision_detection
+
+namespace planning_scene
+{
+class PlanningScene;
+}
+
+namespace reach_ros
+{
+namespace collision
+{
+class SignedDistanceField;
+struct SampledCollisions;
+}  // namespace collision
+}  // namespace reach_ros
+
 namespace reach
 {
 class ReachRecord;
+struct IKSolver;
+struct TargetPoseGenerator;
 }
 
 namespace reach_ros
@@ -34,6 +87,127 @@ namespace utils
 moveit_msgs::CollisionObject createCollisionObject(const std::string& mesh_filename, const std::string& parent_link,
                                                    const std::string& object_name);
 
+/**
+ * @brief Loads a mesh from a resource URI (e.g., `package://` or `file://`), re-using meshes already loaded in this
+ * process
+ * @details If the REACH_ROS_CACHE_DIR environment variable is set, the parsed mesh is also persisted in that directory,
+ * keyed by a hash of the contents of the mesh file, such that later processes loading the same file skip parsing it
+ */
+std::shared_ptr<const shapes::Mesh> loadMesh(const std::string& mesh_filename);
+
+/**
+ * @brief Reads a mesh from a cache file written by writeCachedMesh
+ * @return The mesh, or nullptr if the file does not exist, is truncated, or is otherwise invalid (in which case the
+ * mesh should be re-loaded from its source)
+ */
+std::shared_ptr<const shapes::Mesh> readCachedMesh(const std::string& filename);
+
+/** @brief Writes a mesh to a cache file, without its normals */
+void writeCachedMesh(std::ostream& stream, const shapes::Mesh& mesh);
+
+/**
+ * @brief Computes the 64-bit FNV-1a hash of a byte array
+ * @param hash Hash of the preceding bytes, such that several arrays can be hashed as one
+ */
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t hash = 14695981039346656037ULL);
+
+/**
+ * @brief Returns the path of the file named by a key (in hexadecimal) and an extension in the directory named by the
+ * REACH_ROS_CACHE_DIR environment variable, or an empty string if that variable is not set
+ */
+std::string getCacheFilename(std::uint64_t key, const std::string& extension);
+
+/**
+ * @brief Writes a cache file through a temporary file, such that concurrent processes never read a partially written
+ * file
+ * @details Failures are only reported as warnings, since the cache is an optimization
+ */
+void writeCacheFile(const std::string& filename, const std::function<void(std::ostream&)>& write);
+
+/**
+ * @brief Returns a collision world containing a single object with the input mesh (optionally simplified), attached to
+ * the input frame in the default state of the robot model
+ * @details Worlds are held in a process-wide registry keyed by the robot model, mesh, frame, object name, and
+ * decimation, such that all plugins using the same mesh share one world for as long as any of them holds it. MoveIt
+ * caches the FCL geometry (including the BVH) of each shape, so planning scenes constructed on a shared world only
+ * build the BVH of the mesh once. The returned world is shared and must not be modified
+ * @param decimation_error Optional output maximum distance (m) between the original mesh and the mesh in the world (see
+ * collision::decimateMesh), by which the robot links must be padded in checks against the world, or 0 if the mesh is
+ * not simplified
+ */
+collision_detection::WorldPtr getCollisionWorld(const moveit::core::RobotModelConstPtr& model,
+                                                const std::string& mesh_filename, const std::string& frame,
+                                                const std::string& object_name,
+                                                const collision::MeshDecimation& decimation = {},
+                                                double* decimation_error = nullptr);
+
+/**
+ * @brief Returns the signed distance field of a mesh (optionally simplified) attached to the input frame in the default
+ * state of the robot model, in the model frame
+ * @details Fields are held in a process-wide registry in the same way as collision worlds. If the REACH_ROS_CACHE_DIR
+ * environment variable is set, fields are also persisted in that directory, keyed by a hash of the (simplified) mesh,
+ * its pose, and the field parameters
+ */
+std::shared_ptr<const collision::SignedDistanceField>
+getSignedDistanceField(const moveit::core::RobotModelConstPtr& model, const std::string& mesh_filename,
+                       const std::string& frame, double resolution, double max_distance,
+                       const collision::MeshDecimation& decimation = {});
+
+/**
+ * @brief Returns the pairs of robot links that never or always collide in random configurations of a planning group
+ * (see collision::sampleSelfCollisions), other than those whose collision is allowed by the SRDF
+ * @details Results are held for the lifetime of the process. If the REACH_ROS_CACHE_DIR environment variable is set,
+ * they are also persisted in that directory, keyed by a hash of the `robot_description` and
+ * `robot_description_semantic` parameters, the planning group, and the number of samples
+ */
+std::shared_ptr<const collision::SampledCollisions>
+getSampledSelfCollisions(const moveit::core::RobotModelConstPtr& model, const std::string& planning_group,
+                         std::size_t n_samples, std::size_t n_threads);
+
+/**
+ * @brief Returns the links of a robot model with the input names
+ * @throws std::runtime_error if the model has no link with one of the names
+ */
+std::set<const moveit::core::LinkModel*> getLinkModels(const moveit::core::RobotModelConstPtr& model,
+                                                       const std::vector<std::string>& link_names);
+
+/**
+ * @brief Computes the minimum distance between the robot and the world of a collision environment, in the same way as
+ * planning_scene::PlanningScene::distanceToCollision, but only for a subset of the robot links
+ * @param state Robot state with up-to-date link transforms
+ * @param links Links whose distance to the world is computed, or an empty set for all links
+ * @param max_distance Distance beyond which the exact distance is not needed. Link and object pairs whose bounding
+ * volumes are farther apart are pruned, and the result is clamped to this distance
+ */
+double getDistanceToWorld(const collision_detection::CollisionEnv& env, const moveit::core::RobotState& state,
+                          const collision_detection::AllowedCollisionMatrix& acm,
+                          const std::set<const moveit::core::LinkModel*>& links,
+                          double max_distance = std::numeric_limits<double>::max());
+
+/**
+ * @brief Returns a key that identifies the distance between the robot and the world of a planning scene: the world
+ * itself, the allowed collisions between its objects and the robot links, and the links whose distance is computed
+ * @details Planning scenes on the same (shared) collision world with the same allowed collisions with that world have
+ * the same key, such that they can share memoized distances (see memoizeDistance). The key must be re-computed when the
+ * allowed collision matrix of the scene changes
+ * @param links Links whose distance to the world is computed, or an empty set for all links
+ */
+std::uint64_t getDistanceQueryKey(const planning_scene::PlanningScene& scene,
+                                  const std::set<const moveit::core::LinkModel*>& links);
+
+/**
+ * @brief Returns the distance of a recent query with the same key and the exact same robot state from a small memo of
+ * the calling thread, or computes and memoizes the distance if there is no such query
+ * @details This lets plugins that compute the same distance for the same state (e.g., the clearance check of an IK
+ * solver and the distance penalty evaluator scoring its solution) share a single distance query
+ * @param query_key Key of the distance query (see getDistanceQueryKey)
+ * @param max_distance Bound of the distance query (see getDistanceToWorld). A memoized distance computed with a lower
+ * bound is only reused if it is below that bound
+ * @param compute Function that computes the distance
+ */
+double memoizeDistance(std::uint64_t query_key, const moveit::core::RobotState& state, double max_distance,
+                       const std::function<double()>& compute);
+
 visualization_msgs::Marker makeVisual(const reach::ReachRecord& r, const std::string& frame, const double scale,
                                       const std::string& ns = "reach",
                                       const Eigen::Vector3f& color = { 0.5, 0.5, 0.5 });
@@ -59,6 +233,32 @@ std::vector<double> transcribeInputMap(const std::map<std::string, double>& inpu
  */
 void initROS(const std::string& node_name = "reach_study_plugin_node");
 
+/**
+ * @brief Invokes a function for each index on [0, n) using the calling thread and up to (max_threads - 1) threads of a
+ * process-wide thread pool
+ * @details The function should return false to stop the iteration early, in which case indices that have not yet been
+ * started are skipped. The calling thread always participates in the iteration and never waits on pool threads that
+ * have not yet started, so this function can safely be called from within a function invoked by another call to it.
+ * The first exception thrown by the function is re-thrown in the calling thread
+ */
+void parallelFor(std::size_t n, std::size_t max_threads, const std::function<bool(std::size_t)>& fn);
+
+/**
+ * @brief Loads the IK solver plugin named by the `name` key of the input configuration and creates an IK solver from
+ * that configuration, such that IK solver plugins can wrap other IK solver plugins
+ * @details Plugins are searched for in the reach and reach_ros plugin libraries and in the libraries listed in the
+ * REACH_PLUGINS environment variable. The returned IK solver keeps its plugin factory (and therefore its library)
+ * alive for its lifetime
+ */
+std::shared_ptr<const reach::IKSolver> loadIKSolver(const YAML::Node& config);
+
+/**
+ * @brief Loads the target pose generator plugin named by the `name` key of the input configuration and creates a target
+ * pose generator from that configuration
+ * @details See loadIKSolver for the plugin search paths and lifetime
+ */
+std::shared_ptr<const reach::TargetPoseGenerator> loadTargetPoseGenerator(const YAML::Node& config);
+
 }  // namespace utils
 }  // namespace reach_ros
 
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/capability_map.h>
+#include <reach_ros/ik/moveit_ik_solver.h>
+#include <reach_ros/utils.h>
+
+#include <atomic>
+#include <cmath>
+#include <moveit/common_planning_interface_objects/common_objects.h>
+#include <moveit/robot_state/robot_state.h>
+#include <ros/ros.h>
+#include <thread>
+
+template <typename T>
+T get(const ros::NodeHandle& nh, const std::string& key)
+{
+  T val;
+  if (!nh.getParam(key, val))
+    throw std::runtime_error("Failed to get '" + key + "' parameter");
+  return val;
+}
+
+template <typename T>
+T get(const ros::NodeHandle& nh, const std::string& key, const T& default_val)
+{
+  T val;
+  return nh.getParam(key, val) ? val : default_val;
+}
+
+/**
+ * @brief Builds a capability map of a planning group by solving IK for randomly sampled poses in each position voxel
+ * and tool Z-axis direction bin, without any collision objects other than the robot itself
+ */
+int main(int argc, char** argv)
+{
+  try
+  {
+    ros::init(argc, argv, "capability_map_node");
+    ros::AsyncSpinner spinner(1);
+    spinner.start();
+    ros::NodeHandle pnh("~");
+
+    const auto planning_group = get<std::string>(pnh, "planning_group");
+    const auto output_file = get<std::string>(pnh, "output_file");
+    const auto bounds_min = get<std::vector<double>>(pnh, "bounds_min");
+    const auto bounds_max = get<std::vector<double>>(pnh, "bounds_max");
+    const double resolution = get<double>(pnh, "resolution", 0.05);
+    const int n_direction_divisions = get<int>(pnh, "direction_divisions", 2);
+    const int n_samples = get<int>(pnh, "samples", 32);
+    const int n_random_seeds = get<int>(pnh, "n_random_seeds", 2);
+    const int n_threads = get<int>(pnh, "threads", static_cast<int>(std::thread::hardware_concurrency()));
+
+    if (bounds_min.size() != 3 || bounds_max.size() != 3)
+      throw std::runtime_error("Parameters 'bounds_min' and 'bounds_max' must have 3 elements");
+    if (resolution <= 0.0 || n_direction_divisions < 1 || n_samples < 1)
+      throw std::runtime_error("Parameters 'resolution', 'direction_divisions', and 'samples' must be positive");
+
+    moveit::core::RobotModelConstPtr model = moveit::planning_interface::getSharedRobotModel("robot_description");
+    if (!model)
+      throw std::runtime_error("Failed to initialize robot model pointer");
+
+    // Without a collision mesh or distance threshold, the solver only rejects solutions for joint limits and
+    // self-collision. The random seeds restart solves that fail from the default state, such that a bin is only marked
+    // unreachable when the solver fails from several seeds
+    reach_ros::ik::MoveItIKSolver ik_solver(model, planning_group, 0.0);
+    ik_solver.setNumRandomSeeds(static_cast<std::size_t>(n_random_seeds));
+
+    // Seed every solve from the default state of the planning group
+    moveit::core::RobotState state(model);
+    state.setToDefaultValues();
+    std::map<std::string, double> seed;
+    for (const std::string& joint_name : ik_solver.getJointNames())
+      seed[joint_name] = state.getVariablePosition(joint_name);
+
+    reach_ros::ik::CapabilityMap::Grid grid;
+    grid.origin = Eigen::Vector3d(bounds_min[0], bounds_min[1], bounds_min[2]);
+    grid.resolution = resolution;
+    for (std::size_t i = 0; i < 3; ++i)
+      grid.size[i] = static_cast<std::uint32_t>(std::max(std::ceil((bounds_max[i] - bounds_min[i]) / resolution), 1.0));
+    grid.n_direction_divisions = static_cast<std::uint32_t>(n_direction_divisions);
+
+    const std::size_t n_voxels = grid.getNumVoxels();
+    const std::size_t n_bins = grid.getNumBins();
+    ROS_INFO_STREAM("Building capability map of " << n_voxels << " voxels x " << n_bins << " direction bins with "
+                                                  << n_samples << " samples each");
+
+    std::vector<std::uint8_t> reachability(n_voxels * n_bins, 0);
+    std::atomic<std::size_t> n_finished{ 0 };
+    reach_ros::utils::parallelFor(n_voxels, static_cast<std::size_t>(std::max(n_threads, 1)), [&](std::size_t voxel) {
+      // Seed the samples of each voxel independently, such that the map does not depend on the order of evaluation
+      std::mt19937 rng(static_cast<std::mt19937::result_type>(voxel));
+      std::uniform_real_distribution<double> dist(-0.5, 0.5);
+      const Eigen::Vector3d center = grid.getVoxelCenter(voxel);
+
+      for (std::size_t bin = 0; bin < n_bins; ++bin)
+      {
+        int n_reached = 0;
+        for (int i = 0; i < n_samples; ++i)
+        {
+          // Sample a position within the voxel and a tool Z-axis within the bin, with a random rotation about it
+          const Eigen::Vector3d z = grid.sampleBinDirection(bin, rng);
+          const Eigen::Vector3d x = z.unitOrthogonal();
+          Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+          pose.linear() << x, z.cross(x), z;
+          pose.rotate(Eigen::AngleAxisd(M_PI * 2.0 * dist(rng), Eigen::Vector3d::UnitZ()));
+          pose.translation() = center + resolution * Eigen::Vector3d(dist(rng), dist(rng), dist(rng));
+
+          if (!ik_solver.solveIK(pose, seed).empty())
+            ++n_reached;
+        }
+
+        reachability[voxel * n_bins + bin] =
+            static_cast<std::uint8_t>(std::lround(255.0 * double(n_reached) / double(n_samples)));
+      }
+
+      // Report progress at every 10% of voxels
+      const std::size_t finished = ++n_finished;
+      if (finished * 10 / n_voxels != (finished - 1) * 10 / n_voxels)
+        ROS_INFO_STREAM("Capability map " << finished * 100 / n_voxels << "% complete");
+
+      return ros::ok();
+    });
+
+    if (!ros::ok())
+      throw std::runtime_error("Capability map build was interrupted");
+
+    reach_ros::ik::CapabilityMap::save(output_file, grid, ik_solver.getKinematicsHash(), reachability);
+    ROS_INFO_STREAM("Saved capability map to '" << output_file << "'");
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/clearance_mode.h>
+
+#include <reach/plugin_utils.h>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+
+namespace reach_ros
+{
+namespace collision
+{
+ClearanceMode getClearanceMode(const YAML::Node& config, const std::string& key)
+{
+  if (!config[key])
+    return ClearanceMode::DISTANCE;
+
+  const auto mode = reach::get<std::string>(config, key);
+  if (mode == "distance")
+    return ClearanceMode::DISTANCE;
+  if (mode == "padding")
+    return ClearanceMode::PADDING;
+  if (mode == "sdf")
+    return ClearanceMode::SDF;
+
+  throw std::runtime_error("Invalid clearance mode '" + mode + "'; valid options are 'distance', 'padding', and 'sdf'");
+}
+
+}  // namespace collision
+}  // namespace reach_ros
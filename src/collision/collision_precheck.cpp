@@ -0,0 +1,123 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/collision_precheck.h>
+#include <reach_ros/collision/signed_distance_field.h>
+
+#include <algorithm>
+#include <cmath>
+#include <geometric_shapes/shapes.h>
+#include <moveit/robot_model/joint_model_group.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <set>
+#include <utility>
+
+namespace reach_ros
+{
+namespace collision
+{
+CollisionPrecheck::CollisionPrecheck(std::shared_ptr<const SignedDistanceField> sdf,
+                                     const moveit::core::JointModelGroup* jmg,
+                                     const std::vector<std::string>& excluded_links, double padding,
+                                     std::size_t max_edges_per_shape)
+  : sdf_(std::move(sdf))
+  // The free verdict skips the exact check, so it must hold for every link of the robot, not only those moved by the
+  // planning group
+  , spheres_(excludeLinks(jmg->getParentModel().getLinkModelsWithCollisionGeometry(), excluded_links))
+  // Trilinear interpolation of a 1-Lipschitz function differs from it by at most the length of a cell diagonal. The
+  // grid values of the field are the exact distances clamped to its maximum distance, which is 1-Lipschitz everywhere
+  , error_(std::sqrt(3.0) * sdf_->getResolution())
+  , padding_(std::max(padding, 0.0))
+{
+  // The colliding verdict only needs to hold for some link, so it only checks the links moved by the planning group
+  if (!sdf_->isClosed())
+    return;
+
+  for (const moveit::core::LinkModel* link : excludeLinks(jmg->getUpdatedLinkModelsWithGeometry(), excluded_links))
+  {
+    const std::vector<shapes::ShapeConstPtr>& shapes = link->getShapes();
+    for (std::size_t i = 0; i < shapes.size(); ++i)
+    {
+      // Sphere shapes have no edges, so they are only decided by the spheres
+      std::shared_ptr<const shapes::Mesh> mesh = getShapeMesh(shapes[i]);
+      if (!mesh)
+        continue;
+
+      // Long edges are the most likely to cross the mesh surface when the link penetrates the mesh
+      std::set<std::pair<unsigned int, unsigned int>> unique_edges;
+      for (std::size_t t = 0; t < mesh->triangle_count; ++t)
+      {
+        for (std::size_t v = 0; v < 3; ++v)
+        {
+          unsigned int a = mesh->triangles[3 * t + v];
+          unsigned int b = mesh->triangles[3 * t + (v + 1) % 3];
+          unique_edges.emplace(std::min(a, b), std::max(a, b));
+        }
+      }
+
+      const Eigen::Isometry3d& origin = link->getCollisionOriginTransforms()[i];
+      auto getVertex = [&](unsigned int v) {
+        return Eigen::Vector3d(origin * Eigen::Vector3d(mesh->vertices[3 * v], mesh->vertices[3 * v + 1],
+                                                        mesh->vertices[3 * v + 2]));
+      };
+
+      std::vector<Edge> shape_edges;
+      shape_edges.reserve(unique_edges.size());
+      for (const auto& edge : unique_edges)
+        shape_edges.push_back({ link, getVertex(edge.first), getVertex(edge.second) });
+
+      const std::size_t n_edges = std::min(max_edges_per_shape, shape_edges.size());
+      std::partial_sort(shape_edges.begin(), shape_edges.begin() + long(n_edges), shape_edges.end(),
+                        [](const Edge& lhs, const Edge& rhs) {
+                          return (lhs.b - lhs.a).squaredNorm() > (rhs.b - rhs.a).squaredNorm();
+                        });
+      edges_.insert(edges_.end(), shape_edges.begin(), shape_edges.begin() + long(n_edges));
+    }
+  }
+}
+
+CollisionPrecheck::Result CollisionPrecheck::check(const moveit::core::RobotState& state) const
+{
+  if (spheres_.isClearOf(state, *sdf_, error_ + padding_))
+    return Result::FREE;
+
+  if (!sdf_->isClosed())
+    return Result::UNKNOWN;
+
+  const moveit::core::LinkModel* link = nullptr;
+  const Eigen::Isometry3d* link_pose = nullptr;
+  for (const Edge& edge : edges_)
+  {
+    if (edge.link != link)
+    {
+      link = edge.link;
+      link_pose = &state.getGlobalLinkTransform(link);
+    }
+
+    const double da = sdf_->getDistance(*link_pose * edge.a);
+    if (std::abs(da) <= error_)
+      continue;
+
+    const double db = sdf_->getDistance(*link_pose * edge.b);
+    if ((da < -error_ && db > error_) || (da > error_ && db < -error_))
+      return Result::COLLIDING;
+  }
+
+  return Result::UNKNOWN;
+}
+
+}  // namespace collision
+}  // namespace reach_ros
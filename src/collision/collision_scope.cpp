@@ -0,0 +1,53 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/collision_scope.h>
+
+#include <reach/plugin_utils.h>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+
+namespace reach_ros
+{
+namespace collision
+{
+bool includesWorld(CollisionScope scope)
+{
+  return scope != CollisionScope::SELF;
+}
+
+bool includesSelf(CollisionScope scope)
+{
+  return scope != CollisionScope::WORLD;
+}
+
+CollisionScope getCollisionScope(const YAML::Node& config, CollisionScope default_scope, const std::string& key)
+{
+  if (!config[key])
+    return default_scope;
+
+  const auto scope = reach::get<std::string>(config, key);
+  if (scope == "world")
+    return CollisionScope::WORLD;
+  if (scope == "self")
+    return CollisionScope::SELF;
+  if (scope == "both")
+    return CollisionScope::BOTH;
+
+  throw std::runtime_error("Invalid collision scope '" + scope + "'; valid options are 'world', 'self', and 'both'");
+}
+
+}  // namespace collision
+}  // namespace reach_ros
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/link_spheres.h>
+#include <reach_ros/collision/signed_distance_field.h>
+
+#include <algorithm>
+#include <cmath>
+#include <geometric_shapes/shape_operations.h>
+#include <geometric_shapes/shapes.h>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <moveit/robot_model/joint_model_group.h>
+#include <moveit/robot_state/robot_state.h>
+#include <set>
+#include <stdexcept>
+
+namespace
+{
+using Polygon = std::vector<Eigen::Vector3d>;
+
+/** @brief Clips a convex polygon to the half-space in which the input coordinate is above (or below) a bound */
+void clip(Polygon& polygon, Eigen::Index axis, double bound, bool keep_above)
+{
+  Polygon clipped;
+  for (std::size_t i = 0; i < polygon.size(); ++i)
+  {
+    const Eigen::Vector3d& a = polygon[i];
+    const Eigen::Vector3d& b = polygon[(i + 1) % polygon.size()];
+    const double da = keep_above ? a[axis] - bound : bound - a[axis];
+    const double db = keep_above ? b[axis] - bound : bound - b[axis];
+
+    if (da >= 0.0)
+      clipped.push_back(a);
+    if ((da >= 0.0) != (db >= 0.0))
+      clipped.push_back(a + (b - a) * (da / (da - db)));
+  }
+
+  polygon = std::move(clipped);
+}
+
+/** @brief Appends the spheres enclosing the slabs of a mesh, whose vertices are transformed into the link frame */
+void addMeshSpheres(const moveit::core::LinkModel* link, const shapes::Mesh& mesh, const Eigen::Isometry3d& origin,
+                    std::size_t max_spheres, std::vector<reach_ros::collision::LinkSpheres::Sphere>& spheres)
+{
+  if (mesh.triangle_count == 0)
+    return;
+
+  std::vector<Eigen::Vector3d> vertices(mesh.vertex_count);
+  Eigen::AlignedBox3d bounds;
+  for (std::size_t i = 0; i < mesh.vertex_count; ++i)
+  {
+    vertices[i] = origin * Eigen::Vector3d(mesh.vertices[3 * i], mesh.vertices[3 * i + 1], mesh.vertices[3 * i + 2]);
+    bounds.extend(vertices[i]);
+  }
+
+  // Cut the shape into slabs about as thick as the shape is wide, such that the spheres fit the slabs tightly
+  const Eigen::Vector3d sizes = bounds.sizes();
+  Eigen::Index axis;
+  const double length = sizes.maxCoeff(&axis);
+  const double width = std::max(sizes[(axis + 1) % 3], sizes[(axis + 2) % 3]);
+  std::size_t n_slabs = 1;
+  if (width > 0.0)
+    n_slabs = std::min(std::max<std::size_t>(std::size_t(std::ceil(length / width)), 1), max_spheres);
+  else if (length > 0.0)
+    n_slabs = max_spheres;
+  const double thickness = length / double(n_slabs);
+
+  // Collect the parts of the triangles within each slab
+  std::vector<std::vector<Eigen::Vector3d>> slab_points(n_slabs);
+  for (std::size_t t = 0; t < mesh.triangle_count; ++t)
+  {
+    const Polygon triangle = { vertices[mesh.triangles[3 * t]], vertices[mesh.triangles[3 * t + 1]],
+                               vertices[mesh.triangles[3 * t + 2]] };
+    double lower = std::numeric_limits<double>::infinity();
+    double upper = -std::numeric_limits<double>::infinity();
+    for (const Eigen::Vector3d& v : triangle)
+    {
+      lower = std::min(lower, v[axis]);
+      upper = std::max(upper, v[axis]);
+    }
+
+    const double min = bounds.min()[axis];
+    std::size_t first = 0;
+    std::size_t last = 0;
+    if (thickness > 0.0)
+    {
+      first = std::min(std::size_t(std::max((lower - min) / thickness, 0.0)), n_slabs - 1);
+      last = std::min(std::size_t(std::max((upper - min) / thickness, 0.0)), n_slabs - 1);
+    }
+    for (std::size_t s = first; s <= last; ++s)
+    {
+      Polygon polygon = triangle;
+      if (s > 0)
+        clip(polygon, axis, min + thickness * double(s), true);
+      if (s + 1 < n_slabs)
+        clip(polygon, axis, min + thickness * double(s + 1), false);
+      slab_points[s].insert(slab_points[s].end(), polygon.begin(), polygon.end());
+    }
+  }
+
+  for (const std::vector<Eigen::Vector3d>& points : slab_points)
+  {
+    if (points.empty())
+      continue;
+
+    Eigen::AlignedBox3d slab_bounds;
+    for (const Eigen::Vector3d& p : points)
+      slab_bounds.extend(p);
+
+    reach_ros::collision::LinkSpheres::Sphere sphere;
+    sphere.link = link;
+    sphere.center = slab_bounds.center();
+    sphere.radius = 0.0;
+    for (const Eigen::Vector3d& p : points)
+      sphere.radius = std::max(sphere.radius, (p - sphere.center).norm());
+
+    spheres.push_back(sphere);
+  }
+}
+
+}  // namespace
+
+namespace reach_ros
+{
+namespace collision
+{
+std::shared_ptr<const shapes::Mesh> getShapeMesh(const std::shared_ptr<const shapes::Shape>& shape)
+{
+  switch (shape->type)
+  {
+    case shapes::MESH:
+      return std::static_pointer_cast<const shapes::Mesh>(shape);
+    case shapes::BOX:
+    case shapes::CYLINDER:
+    case shapes::CONE:
+      return std::shared_ptr<const shapes::Mesh>(shapes::createMeshFromShape(shape.get()));
+    default:
+      return nullptr;
+  }
+}
+
+std::vector<const moveit::core::LinkModel*> excludeLinks(const std::vector<const moveit::core::LinkModel*>& links,
+                                                        const std::vector<std::string>& excluded_links)
+{
+  const std::set<std::string> excluded(excluded_links.begin(), excluded_links.end());
+  std::vector<const moveit::core::LinkModel*> result;
+  std::copy_if(links.begin(), links.end(), std::back_inserter(result),
+               [&excluded](const moveit::core::LinkModel* link) { return !excluded.count(link->getName()); });
+  return result;
+}
+
+LinkSpheres::LinkSpheres(const moveit::core::JointModelGroup* jmg, const std::vector<std::string>& excluded_links,
+                         std::size_t max_spheres_per_shape)
+  : LinkSpheres(excludeLinks(jmg->getUpdatedLinkModelsWithGeometry(), excluded_links), max_spheres_per_shape)
+{
+}
+
+LinkSpheres::LinkSpheres(const std::vector<const moveit::core::LinkModel*>& links, std::size_t max_spheres_per_shape)
+{
+  max_spheres_per_shape = std::max<std::size_t>(max_spheres_per_shape, 1);
+
+  offsets_.push_back(0);
+  for (const moveit::core::LinkModel* link : links)
+  {
+    const std::vector<shapes::ShapeConstPtr>& shapes = link->getShapes();
+    for (std::size_t i = 0; i < shapes.size(); ++i)
+    {
+      const Eigen::Isometry3d& origin = link->getCollisionOriginTransforms()[i];
+      if (shapes[i]->type == shapes::SPHERE)
+      {
+        spheres_.push_back({ link, origin.translation(), static_cast<const shapes::Sphere&>(*shapes[i]).radius });
+        continue;
+      }
+
+      std::shared_ptr<const shapes::Mesh> mesh = getShapeMesh(shapes[i]);
+      if (!mesh)
+        throw std::runtime_error("Collision shape of link '" + link->getName() + "' cannot be enclosed by spheres");
+      addMeshSpheres(link, *mesh, origin, max_spheres_per_shape, spheres_);
+    }
+
+    if (spheres_.size() == offsets_.back())
+      continue;
+
+    // Enclose the spheres of the link by a sphere about the center of their bounding box
+    Eigen::AlignedBox3d bounds;
+    for (std::size_t i = offsets_.back(); i < spheres_.size(); ++i)
+    {
+      bounds.extend(spheres_[i].center - Eigen::Vector3d::Constant(spheres_[i].radius));
+      bounds.extend(spheres_[i].center + Eigen::Vector3d::Constant(spheres_[i].radius));
+    }
+
+    Sphere bound{ link, bounds.center(), 0.0 };
+    for (std::size_t i = offsets_.back(); i < spheres_.size(); ++i)
+      bound.radius = std::max(bound.radius, (spheres_[i].center - bound.center).norm() + spheres_[i].radius);
+
+    bounds_.push_back(bound);
+    offsets_.push_back(spheres_.size());
+  }
+}
+
+const std::vector<LinkSpheres::Sphere>& LinkSpheres::getSpheres() const
+{
+  return spheres_;
+}
+
+double LinkSpheres::getDistance(const moveit::core::RobotState& state, const SignedDistanceField& sdf) const
+{
+  double distance = sdf.getMaxDistance();
+  for (std::size_t i = 0; i < bounds_.size(); ++i)
+  {
+    // Distances are 1-Lipschitz, so no sphere within the bounding sphere is closer than the bounding sphere
+    const Eigen::Isometry3d& link_pose = state.getGlobalLinkTransform(bounds_[i].link);
+    if (sdf.getDistance(link_pose * bounds_[i].center) - bounds_[i].radius >= distance)
+      continue;
+
+    for (std::size_t j = offsets_[i]; j < offsets_[i + 1]; ++j)
+      distance = std::min(distance, sdf.getDistance(link_pose * spheres_[j].center) - spheres_[j].radius);
+  }
+
+  return distance;
+}
+
+bool LinkSpheres::isClearOf(const moveit::core::RobotState& state, const SignedDistanceField& sdf,
+                            double distance) const
+{
+  for (std::size_t i = 0; i < bounds_.size(); ++i)
+  {
+    const Eigen::Isometry3d& link_pose = state.getGlobalLinkTransform(bounds_[i].link);
+    if (sdf.getDistance(link_pose * bounds_[i].center) - bounds_[i].radius >= distance)
+      continue;
+
+    for (std::size_t j = offsets_[i]; j < offsets_[i + 1]; ++j)
+    {
+      if (sdf.getDistance(link_pose * spheres_[j].center) - spheres_[j].radius < distance)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace collision
+}  // namespace reach_ros
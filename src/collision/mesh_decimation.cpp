@@ -0,0 +1,352 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/mesh_decimation.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <geometric_shapes/shapes.h>
+#include <limits>
+#include <map>
+#include <reach/plugin_utils.h>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace
+{
+using Cell = std::array<long, 3>;
+/** @brief Face of a grid cell, given by the cell and the axis normal to the face, at the lower bound of the cell */
+using Face = std::array<long, 4>;
+/**
+ * @brief Rectangle of coplanar cell faces, given by the axis normal to it, its plane, and its lower and upper corners
+ * along the other two axes (in the order of the axes following the normal)
+ */
+using Rectangle = std::array<long, 6>;
+using Triangle = std::array<Eigen::Vector3d, 3>;
+
+/**
+ * @brief Number of cell faces per triangle of the maximum triangle count beyond which the faces are no longer
+ * collected, since merging coplanar faces rarely reduces them that much
+ */
+const std::size_t MAX_FACES_PER_TRIANGLE = 16;
+
+template <typename T>
+struct ArrayHash
+{
+  std::size_t operator()(const T& a) const
+  {
+    std::size_t hash = 0;
+    for (const auto& value : a)
+      hash ^= std::hash<typename T::value_type>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+  }
+};
+
+Eigen::Vector3d getVertex(const shapes::Mesh& mesh, std::size_t i)
+{
+  return Eigen::Vector3d(mesh.vertices[3 * i], mesh.vertices[3 * i + 1], mesh.vertices[3 * i + 2]);
+}
+
+Cell getCell(const Eigen::Vector3d& v, double cell_size)
+{
+  return { static_cast<long>(std::floor(v.x() / cell_size)), static_cast<long>(std::floor(v.y() / cell_size)),
+           static_cast<long>(std::floor(v.z() / cell_size)) };
+}
+
+/**
+ * @brief Collects the faces of every grid cell touched by a mesh
+ * @details Each triangle is split at its longest edge until its parts are smaller than half a cell, and the cells
+ * overlapping the bounding boxes of the parts are collected, which are a tight superset of the cells touched by the
+ * triangle
+ * @return False if there are more than the maximum number of faces, in which case the collection is stopped
+ */
+bool collectFaces(const shapes::Mesh& mesh, double cell_size, std::size_t max_faces, std::vector<Face>& faces)
+{
+  std::unordered_set<Cell, ArrayHash<Cell>> cells;
+  std::unordered_set<Face, ArrayHash<Face>> unique;
+  std::vector<Triangle> parts;
+  for (std::size_t i = 0; i < mesh.triangle_count; ++i)
+  {
+    parts.push_back({ getVertex(mesh, mesh.triangles[3 * i]), getVertex(mesh, mesh.triangles[3 * i + 1]),
+                      getVertex(mesh, mesh.triangles[3 * i + 2]) });
+    while (!parts.empty())
+    {
+      const Triangle t = parts.back();
+      parts.pop_back();
+
+      std::size_t longest = 0;
+      for (std::size_t j = 1; j < 3; ++j)
+        if ((t[(j + 1) % 3] - t[j]).squaredNorm() > (t[(longest + 1) % 3] - t[longest]).squaredNorm())
+          longest = j;
+
+      const Eigen::Vector3d& a = t[longest];
+      const Eigen::Vector3d& b = t[(longest + 1) % 3];
+      const Eigen::Vector3d& c = t[(longest + 2) % 3];
+      if ((b - a).norm() > 0.5 * cell_size)
+      {
+        const Eigen::Vector3d m = 0.5 * (a + b);
+        parts.push_back({ a, m, c });
+        parts.push_back({ m, b, c });
+        continue;
+      }
+
+      const Cell min = getCell(a.cwiseMin(b).cwiseMin(c), cell_size);
+      const Cell max = getCell(a.cwiseMax(b).cwiseMax(c), cell_size);
+      for (long x = min[0]; x <= max[0]; ++x)
+      {
+        for (long y = min[1]; y <= max[1]; ++y)
+        {
+          for (long z = min[2]; z <= max[2]; ++z)
+          {
+            const Cell cell{ x, y, z };
+            if (!cells.insert(cell).second)
+              continue;
+
+            // Each cell has a lower and an upper face normal to each axis
+            for (long axis = 0; axis < 3; ++axis)
+            {
+              Face upper{ x, y, z, axis };
+              ++upper[axis];
+              unique.insert(Face{ x, y, z, axis });
+              unique.insert(upper);
+            }
+
+            if (unique.size() > max_faces)
+              return false;
+          }
+        }
+      }
+    }
+  }
+
+  // Sort the faces, such that the simplified mesh does not depend on the order of the hash sets
+  faces.assign(unique.begin(), unique.end());
+  std::sort(faces.begin(), faces.end());
+  return true;
+}
+
+/**
+ * @brief Merges the coplanar faces of a grid into rectangles
+ * @details The faces of each plane are merged greedily: each rectangle is first extended along the second axis of the
+ * plane, and then along the first axis for as long as the whole edge is covered by faces
+ */
+std::vector<Rectangle> mergeFaces(const std::vector<Face>& faces)
+{
+  std::map<std::array<long, 2>, std::set<std::array<long, 2>>> planes;
+  for (const Face& face : faces)
+  {
+    const long axis = face[3];
+    planes[{ axis, face[axis] }].insert({ face[(axis + 1) % 3], face[(axis + 2) % 3] });
+  }
+
+  std::vector<Rectangle> rectangles;
+  for (auto& plane : planes)
+  {
+    std::set<std::array<long, 2>>& cells = plane.second;
+    while (!cells.empty())
+    {
+      const std::array<long, 2> lower = *cells.begin();
+      std::array<long, 2> upper = lower;
+      while (cells.count({ upper[0], upper[1] + 1 }))
+        ++upper[1];
+
+      auto coversRow = [&](long u) {
+        for (long v = lower[1]; v <= upper[1]; ++v)
+          if (!cells.count({ u, v }))
+            return false;
+        return true;
+      };
+      while (coversRow(upper[0] + 1))
+        ++upper[0];
+
+      for (long u = lower[0]; u <= upper[0]; ++u)
+        for (long v = lower[1]; v <= upper[1]; ++v)
+          cells.erase({ u, v });
+
+      rectangles.push_back({ plane.first[0], plane.first[1], lower[0], lower[1], upper[0] + 1, upper[1] + 1 });
+    }
+  }
+
+  return rectangles;
+}
+
+/** @brief Creates a mesh of two triangles per rectangle of a grid with the input cell size */
+std::shared_ptr<shapes::Mesh> createRectangleMesh(const std::vector<Rectangle>& rectangles, double cell_size)
+{
+  std::unordered_map<Cell, unsigned int, ArrayHash<Cell>> corners;
+  std::vector<Cell> vertices;
+  std::vector<unsigned int> triangles;
+  triangles.reserve(6 * rectangles.size());
+
+  auto getCorner = [&](long axis, long plane, long u, long v) {
+    Cell corner;
+    corner[axis] = plane;
+    corner[(axis + 1) % 3] = u;
+    corner[(axis + 2) % 3] = v;
+
+    auto it = corners.emplace(corner, static_cast<unsigned int>(vertices.size())).first;
+    if (it->second == vertices.size())
+      vertices.push_back(corner);
+    return it->second;
+  };
+
+  for (const Rectangle& r : rectangles)
+  {
+    const unsigned int a = getCorner(r[0], r[1], r[2], r[3]);
+    const unsigned int b = getCorner(r[0], r[1], r[4], r[3]);
+    const unsigned int c = getCorner(r[0], r[1], r[4], r[5]);
+    const unsigned int d = getCorner(r[0], r[1], r[2], r[5]);
+    triangles.insert(triangles.end(), { a, b, c, a, c, d });
+  }
+
+  auto mesh = std::make_shared<shapes::Mesh>(static_cast<unsigned int>(vertices.size()),
+                                             static_cast<unsigned int>(triangles.size() / 3));
+  for (std::size_t i = 0; i < vertices.size(); ++i)
+    for (std::size_t j = 0; j < 3; ++j)
+      mesh->vertices[3 * i + j] = double(vertices[i][j]) * cell_size;
+  std::copy(triangles.begin(), triangles.end(), mesh->triangles);
+
+  mesh->computeTriangleNormals();
+  mesh->computeVertexNormals();
+  return mesh;
+}
+
+/**
+ * @brief Collects and merges the faces of the grid cells touched by a mesh
+ * @return False if the merged faces have more than the maximum number of triangles (two per rectangle)
+ */
+bool simplify(const shapes::Mesh& mesh, double cell_size, std::size_t max_triangles,
+              std::vector<Rectangle>& rectangles)
+{
+  std::vector<Face> faces;
+  const std::size_t max_faces = max_triangles < std::numeric_limits<std::size_t>::max() / MAX_FACES_PER_TRIANGLE ?
+                                    max_triangles * MAX_FACES_PER_TRIANGLE :
+                                    std::numeric_limits<std::size_t>::max();
+  if (!collectFaces(mesh, cell_size, max_faces, faces))
+    return false;
+
+  rectangles = mergeFaces(faces);
+  return 2 * rectangles.size() <= max_triangles;
+}
+
+}  // namespace
+
+namespace reach_ros
+{
+namespace collision
+{
+bool MeshDecimation::enabled() const
+{
+  return max_triangles > 0 || tolerance > 0.0;
+}
+
+MeshDecimation getMeshDecimation(const YAML::Node& config, const std::string& key)
+{
+  MeshDecimation decimation;
+  if (!config[key])
+    return decimation;
+
+  const YAML::Node decimation_config = config[key];
+  if (decimation_config["max_triangles"])
+    decimation.max_triangles = reach::get<std::size_t>(decimation_config, "max_triangles");
+  if (decimation_config["tolerance"])
+    decimation.tolerance = std::abs(reach::get<double>(decimation_config, "tolerance"));
+  if (decimation_config["coarse_fine"])
+    decimation.coarse_fine = reach::get<bool>(decimation_config, "coarse_fine");
+
+  if (!decimation.enabled())
+    throw std::runtime_error("Parameter '" + key + "' requires a positive 'max_triangles' or 'tolerance'");
+
+  return decimation;
+}
+
+std::shared_ptr<const shapes::Mesh> decimateMesh(const shapes::Mesh& mesh, const MeshDecimation& decimation,
+                                                 double& error)
+{
+  error = 0.0;
+  auto cloneOriginal = [&mesh] {
+    return std::shared_ptr<const shapes::Mesh>(static_cast<shapes::Mesh*>(mesh.clone()));
+  };
+
+  const bool meets_max_triangles = decimation.max_triangles == 0 || mesh.triangle_count <= decimation.max_triangles;
+  if ((meets_max_triangles && decimation.tolerance <= 0.0) || mesh.triangle_count == 0)
+    return cloneOriginal();
+
+  // Every point of a cell is at most half a cell size from the nearest face of the cell. Without a tolerance, the
+  // cell size starts at the size of the mesh
+  double max_cell_size = 2.0 * decimation.tolerance;
+  if (max_cell_size <= 0.0)
+  {
+    Eigen::Vector3d min = getVertex(mesh, 0);
+    Eigen::Vector3d max = min;
+    for (std::size_t i = 1; i < mesh.vertex_count; ++i)
+    {
+      min = min.cwiseMin(getVertex(mesh, i));
+      max = max.cwiseMax(getVertex(mesh, i));
+    }
+    max_cell_size = std::max((max - min).norm(), std::numeric_limits<double>::epsilon());
+  }
+
+  const std::size_t max_triangles =
+      decimation.max_triangles > 0 ? decimation.max_triangles : std::numeric_limits<std::size_t>::max();
+  std::vector<Rectangle> rectangles;
+  if (!simplify(mesh, max_cell_size, max_triangles, rectangles))
+  {
+    std::stringstream ss;
+    ss << "Failed to simplify a mesh of " << mesh.triangle_count << " triangles to at most "
+       << decimation.max_triangles << " triangles";
+    if (decimation.tolerance > 0.0)
+      ss << " within a tolerance of " << decimation.tolerance << " m";
+    throw std::runtime_error(ss.str());
+  }
+
+  // Bisect for the smallest cell size (i.e., the most accurate simplified mesh) that meets the triangle count
+  double cell_size = max_cell_size;
+  if (decimation.max_triangles > 0)
+  {
+    double low = 0.0;
+    for (int i = 0; i < 20; ++i)
+    {
+      const double mid = 0.5 * (low + cell_size);
+      std::vector<Rectangle> candidate;
+      if (simplify(mesh, mid, max_triangles, candidate))
+      {
+        cell_size = mid;
+        rectangles = std::move(candidate);
+      }
+      else
+      {
+        low = mid;
+      }
+    }
+  }
+
+  // The original mesh is exact, so it is kept unless the simplified mesh is smaller
+  if (2 * rectangles.size() >= mesh.triangle_count)
+    return cloneOriginal();
+
+  error = 0.5 * cell_size;
+  return createRectangleMesh(rectangles, cell_size);
+}
+
+}  // namespace collision
+}  // namespace reach_ros
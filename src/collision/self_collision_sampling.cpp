@@ -0,0 +1,163 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/self_collision_sampling.h>
+#include <reach_ros/utils.h>
+
+#include <algorithm>
+#include <istream>
+#include <moveit/collision_detection_fcl/collision_env_fcl.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <mutex>
+#include <ostream>
+#include <random_numbers/random_numbers.h>
+#include <unordered_map>
+
+namespace
+{
+const std::string SAMPLED_COLLISIONS_MAGIC = "RRACM1";
+
+/** @brief Number of chunks into which the samples are split, each of which is seeded by its index */
+const std::size_t N_CHUNKS = 64;
+
+}  // namespace
+
+namespace reach_ros
+{
+namespace collision
+{
+void SampledCollisions::apply(collision_detection::AllowedCollisionMatrix& acm) const
+{
+  for (const auto& pair : never_colliding)
+    acm.setEntry(pair.first, pair.second, true);
+  for (const auto& pair : always_colliding)
+    acm.setEntry(pair.first, pair.second, true);
+}
+
+std::shared_ptr<SampledCollisions> SampledCollisions::read(std::istream& stream)
+{
+  std::string magic;
+  auto collisions = std::make_shared<SampledCollisions>();
+  if (!(stream >> magic >> collisions->n_samples) || magic != SAMPLED_COLLISIONS_MAGIC || stream.get() != '\n')
+    return nullptr;
+
+  // Every line ends with a newline, such that a file truncated within a line is rejected
+  std::string type, first, second;
+  while (stream >> type)
+  {
+    if (!(stream >> first >> second) || stream.get() != '\n')
+      return nullptr;
+
+    if (type == "never")
+      collisions->never_colliding.emplace_back(first, second);
+    else if (type == "always")
+      collisions->always_colliding.emplace_back(first, second);
+    else
+      return nullptr;
+  }
+
+  return stream.eof() ? collisions : nullptr;
+}
+
+void SampledCollisions::write(std::ostream& stream) const
+{
+  stream << SAMPLED_COLLISIONS_MAGIC << " " << n_samples << "\n";
+  for (const auto& pair : never_colliding)
+    stream << "never " << pair.first << " " << pair.second << "\n";
+  for (const auto& pair : always_colliding)
+    stream << "always " << pair.first << " " << pair.second << "\n";
+}
+
+SampledCollisions sampleSelfCollisions(const moveit::core::RobotModelConstPtr& model,
+                                       const collision_detection::AllowedCollisionMatrix& acm,
+                                       const moveit::core::JointModelGroup* jmg, std::size_t n_samples,
+                                       std::size_t n_threads)
+{
+  SampledCollisions collisions;
+  collisions.n_samples = n_samples;
+  if (n_samples == 0)
+    return collisions;
+
+  // Index the pairs of links with collision geometry that are not already allowed to collide
+  const std::vector<std::string>& links = model->getLinkModelNamesWithCollisionGeometry();
+  std::vector<std::pair<std::string, std::string>> pairs;
+  std::unordered_map<std::string, std::unordered_map<std::string, std::size_t>> pair_indices;
+  for (std::size_t i = 0; i < links.size(); ++i)
+  {
+    for (std::size_t j = i + 1; j < links.size(); ++j)
+    {
+      collision_detection::AllowedCollision::Type type;
+      if (acm.getEntry(links[i], links[j], type) && type == collision_detection::AllowedCollision::ALWAYS)
+        continue;
+
+      pair_indices[links[i]][links[j]] = pairs.size();
+      pair_indices[links[j]][links[i]] = pairs.size();
+      pairs.emplace_back(links[i], links[j]);
+    }
+  }
+
+  collision_detection::CollisionEnvFCL env(model);
+  collision_detection::CollisionRequest req;
+  req.contacts = true;
+  req.max_contacts = std::max<std::size_t>(pairs.size(), 1);
+  req.max_contacts_per_pair = 1;
+
+  std::vector<std::size_t> counts(pairs.size(), 0);
+  std::mutex mutex;
+  utils::parallelFor(N_CHUNKS, n_threads, [&](std::size_t chunk) {
+    moveit::core::RobotState state(model);
+    state.setToDefaultValues();
+    random_numbers::RandomNumberGenerator rng(static_cast<std::uint32_t>(chunk));
+
+    std::vector<std::size_t> chunk_counts(pairs.size(), 0);
+    for (std::size_t sample = chunk; sample < n_samples; sample += N_CHUNKS)
+    {
+      state.setToRandomPositions(jmg, rng);
+      state.update();
+
+      collision_detection::CollisionResult res;
+      env.checkSelfCollision(req, res, state, acm);
+      for (const auto& contact : res.contacts)
+      {
+        auto it = pair_indices.find(contact.first.first);
+        if (it == pair_indices.end())
+          continue;
+        auto jt = it->second.find(contact.first.second);
+        if (jt != it->second.end())
+          ++chunk_counts[jt->second];
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t i = 0; i < counts.size(); ++i)
+      counts[i] += chunk_counts[i];
+
+    return true;
+  });
+
+  for (std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    if (counts[i] == 0)
+      collisions.never_colliding.push_back(pairs[i]);
+    else if (counts[i] == n_samples)
+      collisions.always_colliding.push_back(pairs[i]);
+  }
+
+  return collisions;
+}
+
+}  // namespace collision
+}  // namespace reach_ros
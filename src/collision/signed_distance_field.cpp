@@ -0,0 +1,594 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/signed_distance_field.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <geometric_shapes/shapes.h>
+#include <istream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+const char SDF_MAGIC[8] = { 'R', 'R', 'S', 'D', 'F', '\0', '\0', '\0' };
+
+/**
+ * @brief Minimum half-width of the band of grid points whose distances are computed exactly, in grid cells, such that
+ * the band separates the inside of a closed mesh from the outside
+ */
+const double BAND_CELLS = 2.0;
+
+/** @brief Distance within which mesh vertices are merged, in grid cells */
+const double WELD_CELLS = 1.0e-3;
+
+/** @brief Maximum number of grid points of a field (4 GiB of distances) */
+const std::uint64_t MAX_GRID_POINTS = std::uint64_t(1) << 30;
+
+/** @brief Maximum number of triangles in a leaf node of the bounding volume hierarchy of a mesh */
+const std::size_t LEAF_TRIANGLES = 4;
+
+/** @brief Triangle of a mesh, in the frame of the field */
+struct Triangle
+{
+  Eigen::Vector3d a;
+  Eigen::Vector3d b;
+  Eigen::Vector3d c;
+  /** @brief Unit normal of the triangle; degenerate triangles are the segment from a to b, and have no normal */
+  Eigen::Vector3d normal;
+  bool degenerate;
+  Eigen::AlignedBox3d bounds;
+};
+
+/** @brief Node of a bounding volume hierarchy of triangles */
+struct Node
+{
+  Eigen::AlignedBox3d bounds;
+  /** @brief Triangles of a leaf node, on [begin, end) */
+  std::size_t begin;
+  std::size_t end;
+  /** @brief Index of the second child of an inner node (whose first child follows it), or 0 for a leaf node */
+  std::size_t second;
+};
+
+/**
+ * @brief Builds the bounding volume hierarchy of the triangles on [begin, end) by splitting them at the median of the
+ * longest axis of the bounding box of their centers, which reorders the triangles
+ * @return The index of the root node of the hierarchy
+ */
+std::size_t buildTree(std::vector<Triangle>& triangles, std::size_t begin, std::size_t end, std::vector<Node>& nodes)
+{
+  const std::size_t index = nodes.size();
+  nodes.emplace_back();
+
+  Node node;
+  node.begin = begin;
+  node.end = end;
+  node.second = 0;
+  Eigen::AlignedBox3d centers;
+  for (std::size_t t = begin; t < end; ++t)
+  {
+    node.bounds.extend(triangles[t].bounds);
+    centers.extend(triangles[t].bounds.center());
+  }
+
+  if (end - begin > LEAF_TRIANGLES)
+  {
+    Eigen::Index axis;
+    centers.sizes().maxCoeff(&axis);
+    const std::size_t middle = begin + (end - begin) / 2;
+    std::nth_element(triangles.begin() + long(begin), triangles.begin() + long(middle), triangles.begin() + long(end),
+                     [axis](const Triangle& lhs, const Triangle& rhs) {
+                       return lhs.bounds.center()[axis] < rhs.bounds.center()[axis];
+                     });
+
+    buildTree(triangles, begin, middle, nodes);
+    node.second = buildTree(triangles, middle, end, nodes);
+  }
+
+  nodes[index] = node;
+  return index;
+}
+
+Eigen::Vector3d getVertex(const shapes::Mesh& mesh, std::size_t i)
+{
+  return Eigen::Vector3d(mesh.vertices[3 * i], mesh.vertices[3 * i + 1], mesh.vertices[3 * i + 2]);
+}
+
+/**
+ * @brief Merges the vertices closer than a tolerance to each other (e.g., vertices duplicated along the seams of an STL
+ * mesh, or the vertices of sliver triangles) into the first of them
+ * @return The index of the vertex into which each vertex is merged
+ */
+std::vector<std::size_t> weldVertices(const std::vector<Eigen::Vector3d>& vertices, double tolerance)
+{
+  // Vertices within the tolerance of each other are in the same or adjacent cells of a grid with that spacing
+  using Cell = std::array<long, 3>;
+  std::map<Cell, std::vector<std::size_t>> cells;
+  std::vector<std::size_t> welded(vertices.size());
+  for (std::size_t i = 0; i < vertices.size(); ++i)
+  {
+    const Eigen::Vector3d g = vertices[i] / tolerance;
+    const Cell cell = { long(std::floor(g.x())), long(std::floor(g.y())), long(std::floor(g.z())) };
+
+    welded[i] = i;
+    for (long dz = -1; dz <= 1 && welded[i] == i; ++dz)
+    {
+      for (long dy = -1; dy <= 1 && welded[i] == i; ++dy)
+      {
+        for (long dx = -1; dx <= 1 && welded[i] == i; ++dx)
+        {
+          auto it = cells.find({ cell[0] + dx, cell[1] + dy, cell[2] + dz });
+          if (it == cells.end())
+            continue;
+
+          for (std::size_t other : it->second)
+          {
+            if ((vertices[other] - vertices[i]).norm() <= tolerance)
+            {
+              welded[i] = other;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    if (welded[i] == i)
+      cells[cell].push_back(i);
+  }
+
+  return welded;
+}
+
+/**
+ * @brief Checks whether a triangle is thinner than a tolerance, in which case its normal is unreliable. Triangles
+ * whose vertices were welded together are always degenerate
+ */
+bool isDegenerate(const Eigen::Vector3d& a, const Eigen::Vector3d& b, const Eigen::Vector3d& c, double tolerance)
+{
+  const double longest_edge = std::max({ (b - a).norm(), (c - b).norm(), (a - c).norm() });
+  return (b - a).cross(c - a).norm() <= tolerance * longest_edge;
+}
+
+/** @brief Returns the point of a line segment closest to a point */
+Eigen::Vector3d getClosestPoint(const Eigen::Vector3d& p, const Eigen::Vector3d& a, const Eigen::Vector3d& b)
+{
+  const Eigen::Vector3d ab = b - a;
+  const double length_squared = ab.squaredNorm();
+  if (length_squared <= 0.0)
+    return a;
+
+  return a + ab * std::max(0.0, std::min((p - a).dot(ab) / length_squared, 1.0));
+}
+
+/** @brief Returns the point of a triangle closest to a point (Ericson, Real-Time Collision Detection, 5.1.5) */
+Eigen::Vector3d getClosestPoint(const Eigen::Vector3d& p, const Eigen::Vector3d& a, const Eigen::Vector3d& b,
+                                const Eigen::Vector3d& c)
+{
+  const Eigen::Vector3d ab = b - a;
+  const Eigen::Vector3d ac = c - a;
+
+  // Vertex region of a
+  const Eigen::Vector3d ap = p - a;
+  const double d1 = ab.dot(ap);
+  const double d2 = ac.dot(ap);
+  if (d1 <= 0.0 && d2 <= 0.0)
+    return a;
+
+  // Vertex region of b
+  const Eigen::Vector3d bp = p - b;
+  const double d3 = ab.dot(bp);
+  const double d4 = ac.dot(bp);
+  if (d3 >= 0.0 && d4 <= d3)
+    return b;
+
+  // Edge region of ab
+  const double vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+    return a + ab * (d1 / (d1 - d3));
+
+  // Vertex region of c
+  const Eigen::Vector3d cp = p - c;
+  const double d5 = ab.dot(cp);
+  const double d6 = ac.dot(cp);
+  if (d6 >= 0.0 && d5 <= d6)
+    return c;
+
+  // Edge region of ac
+  const double vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+    return a + ac * (d2 / (d2 - d6));
+
+  // Edge region of bc
+  const double va = d3 * d6 - d5 * d4;
+  if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+    return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+  // Face region
+  const double denom = 1.0 / (va + vb + vc);
+  return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+}  // namespace
+
+namespace reach_ros
+{
+namespace collision
+{
+const std::uint32_t SignedDistanceField::VERSION = 3;
+
+SignedDistanceField::SignedDistanceField(const shapes::Mesh& mesh, const Eigen::Isometry3d& pose, double resolution,
+                                         double max_distance)
+  : resolution_(resolution), max_distance_(max_distance)
+{
+  if (resolution_ <= 0.0 || max_distance_ <= 0.0)
+    throw std::runtime_error("Signed distance field resolution and maximum distance must be positive");
+  if (mesh.triangle_count == 0)
+    throw std::runtime_error("Cannot compute the signed distance field of an empty mesh");
+
+  std::vector<Eigen::Vector3d> vertices(mesh.vertex_count);
+  Eigen::AlignedBox3d bounds;
+  for (std::size_t i = 0; i < mesh.vertex_count; ++i)
+  {
+    vertices[i] = pose * getVertex(mesh, i);
+    bounds.extend(vertices[i]);
+  }
+
+  // Weld the vertices far closer than the grid spacing, such that sliver triangles collapse rather than giving
+  // unreliable normals
+  const double weld_tolerance = WELD_CELLS * resolution_;
+  const std::vector<std::size_t> welded = weldVertices(vertices, weld_tolerance);
+
+  // The mesh has a well-defined inside if every edge is shared by exactly two triangles that traverse it in opposite
+  // directions. Triangles that are degenerate once welded have no area, and are left out
+  std::map<std::pair<std::size_t, std::size_t>, std::size_t> edges;
+  for (std::size_t t = 0; t < mesh.triangle_count; ++t)
+  {
+    const std::size_t triangle[3] = { welded[mesh.triangles[3 * t]], welded[mesh.triangles[3 * t + 1]],
+                                      welded[mesh.triangles[3 * t + 2]] };
+    if (isDegenerate(vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]], weld_tolerance))
+      continue;
+
+    for (std::size_t v = 0; v < 3; ++v)
+      ++edges[std::make_pair(triangle[v], triangle[(v + 1) % 3])];
+  }
+
+  closed_ = true;
+  for (const auto& edge : edges)
+  {
+    auto opposite = edges.find(std::make_pair(edge.first.second, edge.first.first));
+    if (edge.second != 1 || opposite == edges.end() || opposite->second != 1)
+      closed_ = false;
+  }
+
+  // Distances are computed exactly up to the maximum distance, beyond which they saturate. Pad the grid such that all
+  // points beyond it are at least the maximum distance from the mesh, and such that its boundary is outside of the band
+  const double band = std::max(BAND_CELLS * resolution_, max_distance_);
+  const double margin = band + resolution_;
+  origin_ = bounds.min() - Eigen::Vector3d::Constant(margin);
+  double n_points = 1.0;
+  for (std::size_t axis = 0; axis < 3; ++axis)
+  {
+    const double axis_points = std::ceil((bounds.sizes()[axis] + 2.0 * margin) / resolution_) + 1.0;
+    size_[axis] = static_cast<std::size_t>(std::min(axis_points, double(MAX_GRID_POINTS)));
+    n_points *= axis_points;
+  }
+
+  if (n_points > double(MAX_GRID_POINTS))
+    throw std::runtime_error("Signed distance field of " + std::to_string(n_points) +
+                             " grid points exceeds the maximum of " + std::to_string(MAX_GRID_POINTS) +
+                             "; increase the resolution or reduce the maximum distance");
+
+  const std::size_t n = size_[0] * size_[1] * size_[2];
+  std::vector<float> distances(n, std::numeric_limits<float>::infinity());
+  std::vector<std::int8_t> signs(n, 0);
+
+  auto getPoint = [this](std::size_t i, std::size_t j, std::size_t k) {
+    return Eigen::Vector3d(origin_ + resolution_ * Eigen::Vector3d(double(i), double(j), double(k)));
+  };
+
+  std::vector<Triangle> triangles;
+  triangles.reserve(mesh.triangle_count);
+  for (std::size_t t = 0; t < mesh.triangle_count; ++t)
+  {
+    Triangle triangle;
+    triangle.a = vertices[welded[mesh.triangles[3 * t]]];
+    triangle.b = vertices[welded[mesh.triangles[3 * t + 1]]];
+    triangle.c = vertices[welded[mesh.triangles[3 * t + 2]]];
+    triangle.bounds = Eigen::AlignedBox3d(triangle.a);
+    triangle.bounds.extend(triangle.b);
+    triangle.bounds.extend(triangle.c);
+
+    // Triangles thinner than the weld tolerance are treated as the segment between their two farthest vertices, which
+    // has a distance but no normal. In a closed mesh, that segment is shared with the adjacent triangles, which then
+    // give the sign
+    triangle.normal = (triangle.b - triangle.a).cross(triangle.c - triangle.a);
+    triangle.degenerate = isDegenerate(triangle.a, triangle.b, triangle.c, weld_tolerance);
+    if (triangle.degenerate)
+    {
+      const double ab = (triangle.b - triangle.a).squaredNorm();
+      const double bc = (triangle.c - triangle.b).squaredNorm();
+      const double ca = (triangle.a - triangle.c).squaredNorm();
+      if (bc > ab && bc >= ca)
+        triangle.a = triangle.c;
+      else if (ca > ab)
+        triangle.b = triangle.c;
+    }
+    else
+    {
+      triangle.normal.normalize();
+    }
+
+    triangles.push_back(triangle);
+  }
+
+  std::vector<Node> nodes;
+  buildTree(triangles, 0, triangles.size(), nodes);
+
+  // Compute the exact distance of each grid point within the band of the mesh from its nearest triangle
+  const double tie = 1.0e-6 * resolution_;
+  std::vector<std::size_t> stack;
+  for (std::size_t k = 0; k < size_[2]; ++k)
+  {
+    for (std::size_t j = 0; j < size_[1]; ++j)
+    {
+      for (std::size_t i = 0; i < size_[0]; ++i)
+      {
+        const Eigen::Vector3d p = getPoint(i, j, k);
+        double distance = std::numeric_limits<double>::infinity();
+        double projection = 0.0;
+        double alignment = 0.0;
+
+        stack.assign(1, 0);
+        while (!stack.empty())
+        {
+          const std::size_t node = stack.back();
+          stack.pop_back();
+
+          const double bound = std::min(distance, band) + tie;
+          if (nodes[node].bounds.squaredExteriorDistance(p) > bound * bound)
+            continue;
+
+          if (nodes[node].second != 0)
+          {
+            // Visit the nearer child first, such that the farther child is more likely to be pruned
+            const std::size_t first = node + 1;
+            const std::size_t second = nodes[node].second;
+            const bool first_nearer =
+                nodes[first].bounds.squaredExteriorDistance(p) <= nodes[second].bounds.squaredExteriorDistance(p);
+            stack.push_back(first_nearer ? second : first);
+            stack.push_back(first_nearer ? first : second);
+            continue;
+          }
+
+          for (std::size_t t = nodes[node].begin; t < nodes[node].end; ++t)
+          {
+            const Triangle& triangle = triangles[t];
+            const Eigen::Vector3d closest_point = triangle.degenerate ?
+                                                      getClosestPoint(p, triangle.a, triangle.b) :
+                                                      getClosestPoint(p, triangle.a, triangle.b, triangle.c);
+            const Eigen::Vector3d offset = p - closest_point;
+            const double triangle_distance = offset.norm();
+            if (triangle_distance > band)
+              continue;
+
+            // Grid points are often (nearly) equidistant from several triangles that share an edge or vertex, of
+            // which the triangle whose normal is most aligned with the offset gives the most reliable sign
+            double triangle_projection = 0.0;
+            double triangle_alignment = 0.0;
+            if (!triangle.degenerate)
+            {
+              triangle_projection = offset.dot(triangle.normal);
+              triangle_alignment = triangle_distance > 0.0 ? std::abs(triangle_projection) / triangle_distance : 1.0;
+            }
+
+            if (triangle_distance < distance - tie ||
+                (triangle_distance < distance + tie && triangle_alignment > alignment))
+            {
+              distance = triangle_distance;
+              projection = triangle_projection;
+              alignment = triangle_alignment;
+            }
+          }
+        }
+
+        if (distance <= band)
+        {
+          const std::size_t idx = getIndex(i, j, k);
+          distances[idx] = float(distance);
+          signs[idx] = projection < 0.0 ? -1 : 1;
+        }
+      }
+    }
+  }
+
+  // Flood the grid points outside of the band from the boundary of the grid; the band separates the inside of a
+  // closed mesh from the boundary, so the grid points that are not reached are inside of the mesh
+  std::deque<std::size_t> queue;
+  auto visit = [&](std::size_t i, std::size_t j, std::size_t k) {
+    const std::size_t idx = getIndex(i, j, k);
+    if (signs[idx] == 0)
+    {
+      signs[idx] = 1;
+      queue.push_back(idx);
+    }
+  };
+
+  for (std::size_t k = 0; k < size_[2]; ++k)
+    for (std::size_t j = 0; j < size_[1]; ++j)
+      for (std::size_t i = 0; i < size_[0]; ++i)
+        if (i == 0 || j == 0 || k == 0 || i == size_[0] - 1 || j == size_[1] - 1 || k == size_[2] - 1)
+          visit(i, j, k);
+
+  while (!queue.empty())
+  {
+    std::size_t idx = queue.front();
+    queue.pop_front();
+
+    const std::size_t i = idx % size_[0];
+    idx /= size_[0];
+    const std::size_t j = idx % size_[1];
+    const std::size_t k = idx / size_[1];
+
+    if (i > 0)
+      visit(i - 1, j, k);
+    if (i + 1 < size_[0])
+      visit(i + 1, j, k);
+    if (j > 0)
+      visit(i, j - 1, k);
+    if (j + 1 < size_[1])
+      visit(i, j + 1, k);
+    if (k > 0)
+      visit(i, j, k - 1);
+    if (k + 1 < size_[2])
+      visit(i, j, k + 1);
+  }
+
+  values_.resize(n);
+  for (std::size_t idx = 0; idx < n; ++idx)
+  {
+    // Grid points that were neither in the band nor reached by the flood are inside of the mesh, and grid points beyond
+    // the band are at least the maximum distance from the mesh
+    const float sign = signs[idx] > 0 ? 1.0f : -1.0f;
+    values_[idx] = sign * std::min(distances[idx], float(max_distance_));
+  }
+}
+
+std::shared_ptr<SignedDistanceField> SignedDistanceField::read(std::istream& stream)
+{
+  char magic[sizeof(SDF_MAGIC)];
+  std::uint32_t version = 0;
+  stream.read(magic, sizeof(magic));
+  stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+  if (!stream || std::memcmp(magic, SDF_MAGIC, sizeof(magic)) != 0 || version != VERSION)
+    return nullptr;
+
+  std::shared_ptr<SignedDistanceField> sdf(new SignedDistanceField());
+  std::uint64_t size[3];
+  stream.read(reinterpret_cast<char*>(sdf->origin_.data()), 3 * sizeof(double));
+  stream.read(reinterpret_cast<char*>(&sdf->resolution_), sizeof(double));
+  stream.read(reinterpret_cast<char*>(&sdf->max_distance_), sizeof(double));
+  stream.read(reinterpret_cast<char*>(size), sizeof(size));
+  std::uint8_t closed = 0;
+  stream.read(reinterpret_cast<char*>(&closed), sizeof(closed));
+  if (!stream || !(sdf->resolution_ > 0.0) || !(sdf->max_distance_ > 0.0) || closed > 1)
+    return nullptr;
+  sdf->closed_ = closed != 0;
+
+  // Check the size of the grid before allocating it, such that a corrupt file cannot overflow the number of grid points
+  // or exhaust memory
+  std::uint64_t n = 1;
+  for (std::size_t axis = 0; axis < 3; ++axis)
+  {
+    if (size[axis] < 2 || size[axis] > MAX_GRID_POINTS / n)
+      return nullptr;
+    n *= size[axis];
+    sdf->size_[axis] = static_cast<std::size_t>(size[axis]);
+  }
+
+  // Streams that cannot seek (e.g., pipes) are only checked by reading them
+  const std::streampos start = stream.tellg();
+  if (start != std::streampos(-1))
+  {
+    stream.seekg(0, std::ios::end);
+    const std::streamoff remaining = stream.tellg() - start;
+    stream.seekg(start);
+    if (!stream || std::uint64_t(remaining) < sizeof(float) * n)
+      return nullptr;
+  }
+
+  sdf->values_.resize(n);
+  stream.read(reinterpret_cast<char*>(sdf->values_.data()), std::streamsize(sizeof(float) * sdf->values_.size()));
+  if (!stream)
+    return nullptr;
+
+  return sdf;
+}
+
+void SignedDistanceField::write(std::ostream& stream) const
+{
+  const std::uint64_t size[3] = { size_[0], size_[1], size_[2] };
+  stream.write(SDF_MAGIC, sizeof(SDF_MAGIC));
+  stream.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+  stream.write(reinterpret_cast<const char*>(origin_.data()), 3 * sizeof(double));
+  stream.write(reinterpret_cast<const char*>(&resolution_), sizeof(double));
+  stream.write(reinterpret_cast<const char*>(&max_distance_), sizeof(double));
+  stream.write(reinterpret_cast<const char*>(size), sizeof(size));
+  const std::uint8_t closed = closed_ ? 1 : 0;
+  stream.write(reinterpret_cast<const char*>(&closed), sizeof(closed));
+  stream.write(reinterpret_cast<const char*>(values_.data()), std::streamsize(sizeof(float) * values_.size()));
+}
+
+double SignedDistanceField::getDistance(const Eigen::Vector3d& point) const
+{
+  const Eigen::Vector3d g = (point - origin_) / resolution_;
+
+  // Points beyond the grid are at least the maximum distance from the mesh
+  if (!(g.x() >= 0.0 && g.y() >= 0.0 && g.z() >= 0.0 && g.x() < double(size_[0] - 1) &&
+        g.y() < double(size_[1] - 1) && g.z() < double(size_[2] - 1)))
+    return max_distance_;
+
+  const std::size_t i = static_cast<std::size_t>(g.x());
+  const std::size_t j = static_cast<std::size_t>(g.y());
+  const std::size_t k = static_cast<std::size_t>(g.z());
+  const double fx = g.x() - double(i);
+  const double fy = g.y() - double(j);
+  const double fz = g.z() - double(k);
+
+  const std::size_t idx = getIndex(i, j, k);
+  const std::size_t dy = size_[0];
+  const std::size_t dz = size_[0] * size_[1];
+  auto lerp = [fx](float v0, float v1) { return double(v0) * (1.0 - fx) + double(v1) * fx; };
+
+  const double c00 = lerp(values_[idx], values_[idx + 1]);
+  const double c10 = lerp(values_[idx + dy], values_[idx + dy + 1]);
+  const double c01 = lerp(values_[idx + dz], values_[idx + dz + 1]);
+  const double c11 = lerp(values_[idx + dy + dz], values_[idx + dy + dz + 1]);
+
+  const double c0 = c00 * (1.0 - fy) + c10 * fy;
+  const double c1 = c01 * (1.0 - fy) + c11 * fy;
+  return c0 * (1.0 - fz) + c1 * fz;
+}
+
+double SignedDistanceField::getResolution() const
+{
+  return resolution_;
+}
+
+double SignedDistanceField::getMaxDistance() const
+{
+  return max_distance_;
+}
+
+bool SignedDistanceField::isClosed() const
+{
+  return closed_;
+}
+
+std::size_t SignedDistanceField::getIndex(std::size_t i, std::size_t j, std::size_t k) const
+{
+  return (k * size_[1] + j) * size_[0] + i;
+}
+
+}  // namespace collision
+}  // namespace reach_ros
@@ -14,11 +14,19 @@
  * limitations under the License.
  */
 #include <reach_ros/evaluation/distance_penalty_moveit.h>
+#include <reach_ros/collision/clearance_mode.h>
+#include <reach_ros/collision/link_spheres.h>
+#include <reach_ros/collision/self_collision_sampling.h>
+#include <reach_ros/collision/signed_distance_field.h>
 #include <reach_ros/utils.h>
 
+#include <algorithm>
+#include <limits>
+#include <moveit/collision_detection_fcl/collision_env_fcl.h>
 #include <moveit/common_planning_interface_objects/common_objects.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <reach/plugin_utils.h>
+#include <thread>
 #include <yaml-cpp/yaml.h>
 
 namespace reach_ros
@@ -27,41 +35,118 @@ namespace evaluation
 {
 DistancePenaltyMoveIt::DistancePenaltyMoveIt(moveit::core::RobotModelConstPtr model, const std::string& planning_group,
                                              const double dist_threshold, int exponent,
-                                             std::string collision_mesh_filename, std::vector<std::string> touch_links)
+                                             std::string collision_mesh_filename, std::vector<std::string> touch_links,
+                                             const collision::MeshDecimation& decimation)
   : model_(model)
   , jmg_(model_->getJointModelGroup(planning_group))
   , dist_threshold_(dist_threshold)
   , exponent_(exponent)
   , collision_mesh_filename_(collision_mesh_filename)
   , touch_links_(std::move(touch_links))
+  , collision_scope_(collision::CollisionScope::WORLD)
+  , max_relevant_distance_(std::numeric_limits<double>::max())
 {
   if (!jmg_)
     throw std::runtime_error("Failed to get joint model group");
 
-  scene_.reset(new planning_scene::PlanningScene(model_));
-
-  // Add the collision mesh object to the planning scene
+  // Create the planning scene on the collision world of the mesh, which is shared with the IK solver if it uses the
+  // same mesh and frame. The score is computed from the full mesh when the simplified mesh is only a coarse pre-check
   const std::string object_name = "reach_object";
-  moveit_msgs::CollisionObject obj =
-      utils::createCollisionObject(collision_mesh_filename_, jmg_->getSolverInstance()->getBaseFrame(), object_name);
-  if (!scene_->processCollisionObjectMsg(obj))
-    throw std::runtime_error("Failed to add collision mesh to planning scene");
+  const collision::MeshDecimation scene_decimation = decimation.coarse_fine ? collision::MeshDecimation() : decimation;
+  double mesh_error;
+  scene_.reset(new planning_scene::PlanningScene(
+      model_, utils::getCollisionWorld(model_, collision_mesh_filename_, jmg_->getSolverInstance()->getBaseFrame(),
+                                       object_name, scene_decimation, &mesh_error)));
+
+  // Distances to a simplified mesh are computed with the links padded by its error, as in the IK solvers, such that
+  // they are not overestimated
+  if (mesh_error > 0.0)
+    world_env_ = std::make_shared<collision_detection::CollisionEnvFCL>(model_, scene_->getWorldNonConst(), mesh_error);
+  else
+    world_env_ = scene_->getCollisionEnv();
 
   scene_->getAllowedCollisionMatrixNonConst().setEntry(object_name, touch_links_, true);
+  distance_query_key_ = utils::getDistanceQueryKey(*scene_, clearance_links_);
 }
 
 double DistancePenaltyMoveIt::calculateScore(const std::map<std::string, double>& pose) const
 {
   // Pull the joints from the planning group out of the input pose map
   std::vector<double> pose_subset = utils::transcribeInputMap(pose, jmg_->getActiveJointModelNames());
+  // The other joints are at their default positions, as in the IK solvers, such that memoized distances match
   moveit::core::RobotState state(model_);
+  state.setToDefaultValues();
   state.setJointGroupPositions(jmg_, pose_subset);
   state.update();
 
-  const double dist = scene_->distanceToCollision(state, scene_->getAllowedCollisionMatrix());
+  const collision_detection::AllowedCollisionMatrix& acm = scene_->getAllowedCollisionMatrix();
+  double dist = max_relevant_distance_;
+  if (collision::includesWorld(collision_scope_))
+    dist = sdf_ ? link_spheres_->getDistance(state, *sdf_) :
+                  utils::memoizeDistance(distance_query_key_, state, max_relevant_distance_, [&] {
+                    return utils::getDistanceToWorld(*world_env_, state, acm, clearance_links_,
+                                                     max_relevant_distance_);
+                  });
+  if (collision::includesSelf(collision_scope_))
+    dist = std::min(dist, scene_->distanceToSelfCollision(state, acm));
+
+  // Distances beyond the relevant distance all receive the same score
+  dist = std::min(dist, max_relevant_distance_);
+
   return std::pow((dist / dist_threshold_), exponent_);
 }
 
+void DistancePenaltyMoveIt::setSignedDistanceField(double resolution, double max_distance)
+{
+  if (resolution <= 0.0)
+    throw std::runtime_error("Signed distance field resolution must be positive");
+
+  sdf_ = utils::getSignedDistanceField(model_, collision_mesh_filename_, jmg_->getSolverInstance()->getBaseFrame(),
+                                       resolution, std::max(max_distance, dist_threshold_ + 2.0 * resolution));
+  updateLinkSpheres();
+}
+
+void DistancePenaltyMoveIt::setClearanceLinks(const std::vector<std::string>& clearance_links)
+{
+  clearance_links_ = utils::getLinkModels(model_, clearance_links);
+  distance_query_key_ = utils::getDistanceQueryKey(*scene_, clearance_links_);
+  if (sdf_)
+    updateLinkSpheres();
+}
+
+void DistancePenaltyMoveIt::setMaxRelevantDistance(double max_relevant_distance)
+{
+  max_relevant_distance_ = max_relevant_distance > 0.0 ? max_relevant_distance : std::numeric_limits<double>::max();
+}
+
+void DistancePenaltyMoveIt::updateLinkSpheres()
+{
+  std::vector<std::string> excluded_links = touch_links_;
+  if (!clearance_links_.empty())
+  {
+    for (const moveit::core::LinkModel* link : jmg_->getUpdatedLinkModelsWithGeometry())
+      if (!clearance_links_.count(link))
+        excluded_links.push_back(link->getName());
+  }
+
+  link_spheres_ = std::make_shared<collision::LinkSpheres>(jmg_, excluded_links);
+}
+
+void DistancePenaltyMoveIt::setSelfCollisionSampling(std::size_t n_samples)
+{
+  if (n_samples == 0)
+    return;
+
+  std::shared_ptr<const collision::SampledCollisions> collisions = utils::getSampledSelfCollisions(
+      model_, jmg_->getName(), n_samples, std::max<std::size_t>(std::thread::hardware_concurrency(), 1));
+  collisions->apply(scene_->getAllowedCollisionMatrixNonConst());
+}
+
+void DistancePenaltyMoveIt::setCollisionScope(collision::CollisionScope scope)
+{
+  collision_scope_ = scope;
+}
+
 reach::Evaluator::ConstPtr DistancePenaltyMoveItFactory::create(const YAML::Node& config) const
 {
   auto planning_group = reach::get<std::string>(config, "planning_group");
@@ -75,8 +160,45 @@ reach::Evaluator::ConstPtr DistancePenaltyMoveItFactory::create(const YAML::Node
   if (!model)
     throw std::runtime_error("Failed to initialize robot model pointer");
 
-  return std::make_shared<DistancePenaltyMoveIt>(model, planning_group, dist_threshold, exponent,
-                                                 collision_mesh_filename, touch_links);
+  auto evaluator = std::make_shared<DistancePenaltyMoveIt>(model, planning_group, dist_threshold, exponent,
+                                                           collision_mesh_filename, touch_links,
+                                                           collision::getMeshDecimation(config));
+
+  // Optionally allow collision between link pairs that never or always collide
+  const std::string self_collision_samples_key = "self_collision_samples";
+  if (config[self_collision_samples_key])
+    evaluator->setSelfCollisionSampling(reach::get<std::size_t>(config, self_collision_samples_key));
+
+  evaluator->setCollisionScope(collision::getCollisionScope(config, collision::CollisionScope::WORLD));
+
+  // Optionally score the distance of a subset of the links
+  const std::string clearance_links_key = "clearance_links";
+  if (config[clearance_links_key])
+    evaluator->setClearanceLinks(reach::get<std::vector<std::string>>(config, clearance_links_key));
+
+  // Optionally bound the distance queries by the largest distance that affects the score
+  const std::string max_relevant_distance_key = "max_relevant_distance";
+  if (config[max_relevant_distance_key])
+    evaluator->setMaxRelevantDistance(reach::get<double>(config, max_relevant_distance_key));
+
+  // Optionally score from the signed distance field of the collision mesh
+  const collision::ClearanceMode clearance_mode = collision::getClearanceMode(config);
+  if (clearance_mode == collision::ClearanceMode::SDF)
+  {
+    const std::string sdf_resolution_key = "sdf_resolution";
+    const std::string sdf_max_distance_key = "sdf_max_distance";
+    double resolution = config[sdf_resolution_key] ? reach::get<double>(config, sdf_resolution_key) : 0.01;
+    double max_distance = config[sdf_max_distance_key] ? reach::get<double>(config, sdf_max_distance_key) : 0.0;
+    evaluator->setSignedDistanceField(resolution, max_distance);
+  }
+  else if (clearance_mode == collision::ClearanceMode::PADDING)
+  {
+    // Padding only tells whether the distance is below the threshold, which does not give a score
+    throw std::runtime_error("Clearance mode 'padding' is not supported by the distance penalty evaluator; valid "
+                             "options are 'distance' and 'sdf'");
+  }
+
+  return evaluator;
 }
 
 }  // namespace evaluation
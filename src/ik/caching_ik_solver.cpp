@@ -0,0 +1,191 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/caching_ik_solver.h>
+#include <reach_ros/utils.h>
+
+#include <cmath>
+#include <reach/plugin_utils.h>
+#include <ros/console.h>
+#include <yaml-cpp/yaml.h>
+
+namespace
+{
+long long quantize(double value, double tolerance)
+{
+  return static_cast<long long>(std::llround(value / tolerance));
+}
+
+}  // namespace
+
+namespace reach_ros
+{
+namespace ik
+{
+std::size_t CachingIKSolver::KeyHash::operator()(const Key& key) const
+{
+  std::size_t hash = 0;
+  for (long long value : key)
+    hash ^= std::hash<long long>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+CachingIKSolver::CachingIKSolver(reach::IKSolver::ConstPtr ik_solver, double position_tolerance,
+                                 double orientation_tolerance, double joint_tolerance, std::size_t max_memory)
+  : ik_solver_(std::move(ik_solver))
+  , position_tolerance_(position_tolerance)
+  , orientation_tolerance_(orientation_tolerance)
+  , joint_tolerance_(joint_tolerance)
+  , max_shard_memory_(max_memory / shards_.size())
+  , n_hits_(0)
+  , n_misses_(0)
+{
+  if (!ik_solver_)
+    throw std::runtime_error("Caching IK solver requires an IK solver to wrap");
+  if (position_tolerance_ <= 0.0 || orientation_tolerance_ <= 0.0 || joint_tolerance_ <= 0.0)
+    throw std::runtime_error("Caching IK solver tolerances must be positive");
+}
+
+CachingIKSolver::~CachingIKSolver()
+{
+  const std::size_t n_hits = n_hits_.load();
+  const std::size_t n_misses = n_misses_.load();
+  if (n_hits + n_misses > 0)
+  {
+    ROS_INFO_STREAM("IK cache: " << n_hits << " hits, " << n_misses << " misses ("
+                                 << 100.0 * double(n_hits) / double(n_hits + n_misses) << "% hit rate)");
+  }
+}
+
+std::vector<std::vector<double>> CachingIKSolver::solveIK(const Eigen::Isometry3d& target,
+                                                          const std::map<std::string, double>& seed) const
+{
+  const Key key = getKey(target, seed);
+  Shard& shard = shards_[KeyHash()(key) % shards_.size()];
+
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end())
+    {
+      // Move the entry to the front of the list as the most recently used
+      shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+      ++n_hits_;
+      return it->second->second;
+    }
+  }
+
+  // Solve without holding the lock, such that other requests to this shard are not blocked. Concurrent misses on the
+  // same key both solve, and the first to finish populates the cache
+  ++n_misses_;
+  std::vector<std::vector<double>> solutions = ik_solver_->solveIK(target, seed);
+
+  const std::size_t memory = getMemory(key, solutions);
+  if (memory > max_shard_memory_)
+    return solutions;
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.index.count(key) == 0)
+  {
+    shard.entries.emplace_front(key, solutions);
+    shard.index.emplace(key, shard.entries.begin());
+    shard.memory += memory;
+
+    // Evict the least recently used entries until the shard is within its share of the memory limit
+    while (shard.memory > max_shard_memory_)
+    {
+      const auto& lru = shard.entries.back();
+      shard.memory -= getMemory(lru.first, lru.second);
+      shard.index.erase(lru.first);
+      shard.entries.pop_back();
+    }
+  }
+
+  return solutions;
+}
+
+std::vector<std::string> CachingIKSolver::getJointNames() const
+{
+  return ik_solver_->getJointNames();
+}
+
+std::uint64_t CachingIKSolver::getKinematicsHash() const
+{
+  return ik::getKinematicsHash(*ik_solver_);
+}
+
+CachingIKSolver::Key CachingIKSolver::getKey(const Eigen::Isometry3d& target,
+                                             const std::map<std::string, double>& seed) const
+{
+  Key key;
+  key.reserve(7 + seed.size());
+
+  const Eigen::Vector3d& position = target.translation();
+  for (Eigen::Index i = 0; i < 3; ++i)
+    key.push_back(quantize(position[i], position_tolerance_));
+
+  // Resolve the sign ambiguity of the quaternion such that equivalent orientations produce the same key
+  Eigen::Quaterniond q(target.linear());
+  if (q.w() < 0.0)
+    q.coeffs() *= -1.0;
+  for (Eigen::Index i = 0; i < 4; ++i)
+    key.push_back(quantize(q.coeffs()[i], orientation_tolerance_));
+
+  // The map is ordered by joint name, so the seed positions are always added in the same order
+  for (const auto& pair : seed)
+    key.push_back(quantize(pair.second, joint_tolerance_));
+
+  return key;
+}
+
+std::size_t CachingIKSolver::getMemory(const Key& key, const std::vector<std::vector<double>>& solutions)
+{
+  // Account for the list node, the hash map node, and the heap-allocated contents of the key and solutions
+  std::size_t memory = 2 * sizeof(Key) + sizeof(std::vector<std::vector<double>>) + 8 * sizeof(void*);
+  memory += key.size() * sizeof(long long);
+  for (const std::vector<double>& solution : solutions)
+    memory += sizeof(solution) + solution.size() * sizeof(double);
+
+  return memory;
+}
+
+reach::IKSolver::ConstPtr CachingIKSolverFactory::create(const YAML::Node& config) const
+{
+  const std::string position_tolerance_key = "position_tolerance";
+  const std::string orientation_tolerance_key = "orientation_tolerance";
+  const std::string joint_tolerance_key = "joint_tolerance";
+  const std::string max_memory_key = "max_cache_memory";
+
+  double position_tolerance =
+      config[position_tolerance_key] ? reach::get<double>(config, position_tolerance_key) : 1.0e-6;
+  double orientation_tolerance =
+      config[orientation_tolerance_key] ? reach::get<double>(config, orientation_tolerance_key) : 1.0e-6;
+  double joint_tolerance = config[joint_tolerance_key] ? reach::get<double>(config, joint_tolerance_key) : 1.0e-6;
+
+  // The memory limit is specified in megabytes. It is read as a signed value because converting a negative value to
+  // an unsigned size is undefined
+  double max_memory = config[max_memory_key] ? reach::get<double>(config, max_memory_key) : 256.0;
+  if (!(max_memory >= 0.0))
+    throw std::runtime_error("Parameter '" + max_memory_key + "' must be non-negative");
+
+  reach::IKSolver::ConstPtr ik_solver = utils::loadIKSolver(config["ik_solver"]);
+  return std::make_shared<CachingIKSolver>(ik_solver, position_tolerance, orientation_tolerance, joint_tolerance,
+                                           static_cast<std::size_t>(max_memory * 1024.0 * 1024.0));
+}
+
+}  // namespace ik
+}  // namespace reach_ros
+
+EXPORT_IK_SOLVER_PLUGIN(reach_ros::ik::CachingIKSolverFactory, CachingIKSolver)
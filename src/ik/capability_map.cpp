@@ -0,0 +1,219 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/capability_map.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+const char MAGIC[8] = { 'R', 'E', 'A', 'C', 'H', 'C', 'M', '\0' };
+const std::uint32_t VERSION = 2;
+
+/** @brief Fixed-size file header, laid out such that it contains no padding */
+struct Header
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t n_direction_divisions;
+  std::uint32_t size[3];
+  std::uint32_t reserved;
+  double resolution;
+  double origin[3];
+  std::uint64_t kinematics_hash;
+};
+static_assert(sizeof(Header) == 72, "Unexpected capability map header size");
+
+}  // namespace
+
+namespace reach_ros
+{
+namespace ik
+{
+std::size_t CapabilityMap::Grid::getNumVoxels() const
+{
+  return std::size_t(size[0]) * size[1] * size[2];
+}
+
+std::size_t CapabilityMap::Grid::getNumBins() const
+{
+  return 6 * std::size_t(n_direction_divisions) * n_direction_divisions;
+}
+
+Eigen::Vector3d CapabilityMap::Grid::getVoxelCenter(std::size_t voxel) const
+{
+  const std::size_t iz = voxel % size[2];
+  const std::size_t iy = (voxel / size[2]) % size[1];
+  const std::size_t ix = voxel / (std::size_t(size[2]) * size[1]);
+  return origin + resolution * Eigen::Vector3d(double(ix) + 0.5, double(iy) + 0.5, double(iz) + 0.5);
+}
+
+bool CapabilityMap::Grid::getVoxel(const Eigen::Vector3d& position, std::size_t& voxel) const
+{
+  const Eigen::Vector3d index = (position - origin) / resolution;
+  std::array<std::size_t, 3> i;
+  for (Eigen::Index axis = 0; axis < 3; ++axis)
+  {
+    if (index[axis] < 0.0 || index[axis] >= double(size[axis]))
+      return false;
+    i[axis] = static_cast<std::size_t>(index[axis]);
+  }
+
+  voxel = (i[0] * size[1] + i[1]) * size[2] + i[2];
+  return true;
+}
+
+std::size_t CapabilityMap::Grid::getBin(const Eigen::Vector3d& direction) const
+{
+  // Project the direction onto the cube face of its dominant axis
+  Eigen::Index axis;
+  direction.cwiseAbs().maxCoeff(&axis);
+  const std::size_t face = 2 * axis + (direction[axis] < 0.0 ? 1 : 0);
+  const double u = direction[(axis + 1) % 3] / std::abs(direction[axis]);
+  const double v = direction[(axis + 2) % 3] / std::abs(direction[axis]);
+
+  const std::size_t n = n_direction_divisions;
+  const std::size_t iu = std::min<std::size_t>(static_cast<std::size_t>((u + 1.0) / 2.0 * n), n - 1);
+  const std::size_t iv = std::min<std::size_t>(static_cast<std::size_t>((v + 1.0) / 2.0 * n), n - 1);
+  return (face * n + iu) * n + iv;
+}
+
+Eigen::Vector3d CapabilityMap::Grid::sampleBinDirection(std::size_t bin, std::mt19937& rng) const
+{
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+  const std::size_t n = n_direction_divisions;
+  const std::size_t iv = bin % n;
+  const std::size_t iu = (bin / n) % n;
+  const std::size_t face = bin / (n * n);
+  const Eigen::Index axis = static_cast<Eigen::Index>(face / 2);
+
+  Eigen::Vector3d direction;
+  direction[axis] = face % 2 == 0 ? 1.0 : -1.0;
+  direction[(axis + 1) % 3] = -1.0 + 2.0 * (double(iu) + dist(rng)) / double(n);
+  direction[(axis + 2) % 3] = -1.0 + 2.0 * (double(iv) + dist(rng)) / double(n);
+  return direction.normalized();
+}
+
+CapabilityMap::CapabilityMap(const std::string& filename)
+  : file_(filename.c_str(), boost::interprocess::read_only), region_(file_, boost::interprocess::read_only)
+{
+  if (region_.get_size() < sizeof(Header))
+    throw std::runtime_error("Capability map file '" + filename + "' is too small to contain a header");
+
+  Header header;
+  std::memcpy(&header, region_.get_address(), sizeof(Header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+    throw std::runtime_error("File '" + filename + "' is not a version " + std::to_string(VERSION) +
+                             " capability map");
+
+  grid_.origin = Eigen::Vector3d(header.origin[0], header.origin[1], header.origin[2]);
+  grid_.resolution = header.resolution;
+  grid_.size = { { header.size[0], header.size[1], header.size[2] } };
+  grid_.n_direction_divisions = header.n_direction_divisions;
+  kinematics_hash_ = header.kinematics_hash;
+
+  if (region_.get_size() != sizeof(Header) + grid_.getNumVoxels() * grid_.getNumBins())
+    throw std::runtime_error("Capability map file '" + filename + "' does not match the size given by its header");
+
+  data_ = static_cast<const std::uint8_t*>(region_.get_address()) + sizeof(Header);
+}
+
+void CapabilityMap::save(const std::string& filename, const Grid& grid, std::uint64_t kinematics_hash,
+                         const std::vector<std::uint8_t>& reachability)
+{
+  if (reachability.size() != grid.getNumVoxels() * grid.getNumBins())
+    throw std::runtime_error("Capability map data does not match the size of its grid");
+
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.n_direction_divisions = grid.n_direction_divisions;
+  std::copy(grid.size.begin(), grid.size.end(), header.size);
+  header.resolution = grid.resolution;
+  std::copy(grid.origin.data(), grid.origin.data() + 3, header.origin);
+  header.kinematics_hash = kinematics_hash;
+
+  std::ofstream file(filename, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  file.write(reinterpret_cast<const char*>(reachability.data()), static_cast<std::streamsize>(reachability.size()));
+  if (!file)
+    throw std::runtime_error("Failed to write capability map file '" + filename + "'");
+}
+
+double CapabilityMap::getReachability(const Eigen::Isometry3d& pose) const
+{
+  std::size_t voxel;
+  if (!grid_.getVoxel(pose.translation(), voxel))
+    return -1.0;
+
+  const std::size_t bin = grid_.getBin(pose.linear().col(2));
+  return double(data_[voxel * grid_.getNumBins() + bin]) / 255.0;
+}
+
+double CapabilityMap::getNeighborhoodReachability(const Eigen::Isometry3d& pose) const
+{
+  // The direction of the tool Z-axis and the directions one bin width away from it, in 8 directions about it. Bins
+  // span at most a quarter turn divided by the number of divisions, at the centers of the cube faces
+  const Eigen::Vector3d z = pose.linear().col(2).normalized();
+  const Eigen::Vector3d u = z.unitOrthogonal();
+  const Eigen::Vector3d v = z.cross(u);
+  const double offset = M_PI / 2.0 / double(grid_.n_direction_divisions);
+  std::vector<std::size_t> bins = { grid_.getBin(z) };
+  for (int i = 0; i < 8; ++i)
+  {
+    const double angle = double(i) * M_PI / 4.0;
+    const Eigen::Vector3d tangent = std::cos(angle) * u + std::sin(angle) * v;
+    bins.push_back(grid_.getBin(std::cos(offset) * z + std::sin(offset) * tangent));
+  }
+
+  double reachability = 0.0;
+  for (int dx = -1; dx <= 1; ++dx)
+  {
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+      for (int dz = -1; dz <= 1; ++dz)
+      {
+        // Reachability outside of the voxel grid is unknown, so it cannot be ruled out
+        std::size_t voxel;
+        if (!grid_.getVoxel(pose.translation() + grid_.resolution * Eigen::Vector3d(dx, dy, dz), voxel))
+          return -1.0;
+
+        for (std::size_t bin : bins)
+          reachability = std::max(reachability, double(data_[voxel * grid_.getNumBins() + bin]) / 255.0);
+      }
+    }
+  }
+
+  return reachability;
+}
+
+const CapabilityMap::Grid& CapabilityMap::getGrid() const
+{
+  return grid_;
+}
+
+std::uint64_t CapabilityMap::getKinematicsHash() const
+{
+  return kinematics_hash_;
+}
+
+}  // namespace ik
+}  // namespace reach_ros
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/capability_map_ik_solver.h>
+#include <reach_ros/utils.h>
+
+#include <reach/plugin_utils.h>
+#include <ros/console.h>
+#include <yaml-cpp/yaml.h>
+
+namespace reach_ros
+{
+namespace ik
+{
+CapabilityMapIKSolver::CapabilityMapIKSolver(reach::IKSolver::ConstPtr ik_solver,
+                                             const std::string& capability_map_filename, double min_reachable_fraction)
+  : ik_solver_(std::move(ik_solver))
+  , map_(capability_map_filename)
+  , min_reachable_fraction_(min_reachable_fraction)
+  , n_rejected_(0)
+  , n_passed_(0)
+{
+  if (!ik_solver_)
+    throw std::runtime_error("Capability map IK solver requires an IK solver to wrap");
+
+  // The map is only valid for the kinematics for which it was built. The wrapped IK solver may itself be a wrapper
+  // (e.g., a caching IK solver), which forwards the hash of the IK solver it wraps
+  if (ik::getKinematicsHash(*ik_solver_) != map_.getKinematicsHash())
+    throw std::runtime_error("Capability map '" + capability_map_filename +
+                             "' was built for a different robot model, planning group, or kinematic base or tip frame "
+                             "than those of the wrapped IK solver");
+}
+
+CapabilityMapIKSolver::~CapabilityMapIKSolver()
+{
+  const std::size_t n_rejected = n_rejected_.load();
+  const std::size_t n_passed = n_passed_.load();
+  if (n_rejected + n_passed > 0)
+  {
+    ROS_INFO_STREAM("Capability map: " << n_rejected << " targets rejected, " << n_passed
+                                       << " targets passed to the IK solver");
+  }
+}
+
+std::vector<std::vector<double>> CapabilityMapIKSolver::solveIK(const Eigen::Isometry3d& target,
+                                                                const std::map<std::string, double>& seed) const
+{
+  // A single sampled bin is weak evidence of unreachability, so only reject targets whose whole neighborhood of voxels
+  // and bins is unreachable. Negative reachability indicates that the neighborhood extends outside of the map
+  const double reachability = map_.getNeighborhoodReachability(target);
+  if (reachability >= 0.0 && reachability <= min_reachable_fraction_)
+  {
+    ++n_rejected_;
+    return {};
+  }
+
+  ++n_passed_;
+  return ik_solver_->solveIK(target, seed);
+}
+
+std::vector<std::string> CapabilityMapIKSolver::getJointNames() const
+{
+  return ik_solver_->getJointNames();
+}
+
+std::uint64_t CapabilityMapIKSolver::getKinematicsHash() const
+{
+  return ik::getKinematicsHash(*ik_solver_);
+}
+
+reach::IKSolver::ConstPtr CapabilityMapIKSolverFactory::create(const YAML::Node& config) const
+{
+  reach::IKSolver::ConstPtr ik_solver = utils::loadIKSolver(config["ik_solver"]);
+  auto capability_map_filename = reach::get<std::string>(config, "capability_map_filename");
+
+  const std::string min_reachable_fraction_key = "min_reachable_fraction";
+  double min_reachable_fraction =
+      config[min_reachable_fraction_key] ? reach::get<double>(config, min_reachable_fraction_key) : 0.0;
+
+  return std::make_shared<CapabilityMapIKSolver>(ik_solver, capability_map_filename, min_reachable_fraction);
+}
+
+}  // namespace ik
+}  // namespace reach_ros
+
+EXPORT_IK_SOLVER_PLUGIN(reach_ros::ik::CapabilityMapIKSolverFactory, CapabilityMapIKSolver)
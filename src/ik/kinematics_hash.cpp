@@ -0,0 +1,34 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/kinematics_hash.h>
+
+#include <stdexcept>
+
+namespace reach_ros
+{
+namespace ik
+{
+std::uint64_t getKinematicsHash(const reach::IKSolver& ik_solver)
+{
+  auto provider = dynamic_cast<const KinematicsHashProvider*>(&ik_solver);
+  if (!provider)
+    throw std::runtime_error("IK solver cannot identify its kinematics; use a MoveIt IK solver, optionally wrapped by "
+                             "the caching, wavefront, or capability map IK solvers");
+  return provider->getKinematicsHash();
+}
+
+}  // namespace ik
+}  // namespace reach_ros
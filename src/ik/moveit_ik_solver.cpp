@@ -14,12 +14,25 @@
  * limitations under the License.
  */
 #include <reach_ros/ik/moveit_ik_solver.h>
+#include <reach_ros/collision/collision_precheck.h>
+#include <reach_ros/collision/link_spheres.h>
+#include <reach_ros/collision/self_collision_sampling.h>
+#include <reach_ros/collision/signed_distance_field.h>
+#include <reach_ros/ik/seed_cache.h>
 #include <reach_ros/utils.h>
 
+#include <algorithm>
+#include <atomic>
+#include <eigen_conversions/eigen_msg.h>
+#include <limits>
+#include <moveit/collision_detection_fcl/collision_env_fcl.h>
 #include <moveit/common_planning_interface_objects/common_objects.h>
+#include <moveit/kinematics_base/kinematics_base.h>
+#include <moveit/robot_model/revolute_joint_model.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit_msgs/PlanningScene.h>
 #include <reach/plugin_utils.h>
+#include <ros/console.h>
 #include <yaml-cpp/yaml.h>
 
 namespace
@@ -30,6 +43,240 @@ T clamp(const T& val, const T& low, const T& high)
   return std::max(low, std::min(val, high));
 }
 
+/**
+ * @brief Determines whether the last active joint of a planning group is a revolute joint coaxial with the Z-axis of
+ * the tip link of its kinematics solver
+ * @return The direction of the joint axis relative to the tip link Z-axis (+1 or -1), or 0 if the axes are not coaxial
+ */
+int getWristAxisSign(const moveit::core::RobotModelConstPtr& model, const moveit::core::JointModelGroup* jmg)
+{
+  const double tolerance = 1.0e-6;
+
+  const moveit::core::JointModel* joint = jmg->getActiveJointModels().back();
+  if (joint->getType() != moveit::core::JointModel::REVOLUTE)
+    return 0;
+
+  std::string tip_frame = jmg->getSolverInstance()->getTipFrame();
+  if (!tip_frame.empty() && tip_frame.front() == '/')
+    tip_frame.erase(0, 1);
+
+  // Walk from the tip link back to the child link of the joint, which must only be separated by fixed joints
+  const moveit::core::LinkModel* link = model->getLinkModel(tip_frame);
+  Eigen::Isometry3d child_to_tip = Eigen::Isometry3d::Identity();
+  while (link && link != joint->getChildLinkModel())
+  {
+    if (link->getParentJointModel()->getType() != moveit::core::JointModel::FIXED)
+      return 0;
+
+    child_to_tip = link->getJointOriginTransform() * child_to_tip;
+    link = link->getParentLinkModel();
+  }
+
+  if (!link)
+    return 0;
+
+  // The joint axis is defined in the child link frame and passes through its origin; express that line in the tip frame
+  const Eigen::Isometry3d tip_to_child = child_to_tip.inverse();
+  const Eigen::Vector3d axis =
+      tip_to_child.linear() * static_cast<const moveit::core::RevoluteJointModel*>(joint)->getAxis();
+  const Eigen::Vector3d point = tip_to_child.translation();
+
+  // The axis must be parallel to the tip Z-axis and pass through the tip origin
+  if (axis.head<2>().norm() > tolerance || point.cross(axis).norm() > tolerance)
+    return 0;
+
+  return axis.z() > 0.0 ? 1 : -1;
+}
+
+/**
+ * @brief Shifts a revolute joint position by multiples of 2 pi such that it falls within the joint limits
+ * @return False if no equivalent position lies within the joint limits, true otherwise
+ */
+bool wrapIntoBounds(double& position, const moveit::core::VariableBounds& bounds)
+{
+  if (!bounds.position_bounded_)
+    return true;
+
+  const double wrapped = position + 2.0 * M_PI * std::ceil((bounds.min_position_ - position) / (2.0 * M_PI));
+  if (wrapped > bounds.max_position_)
+    return false;
+
+  position = wrapped;
+  return true;
+}
+
+/**
+ * @brief Computes a sphere that contains every reachable position of the tip link of the kinematics solver of a
+ * planning group, centered on the parent link of the first active joint (in the default state of the model)
+ * @details The distance between consecutive link origins is bounded by the length of the joint origin translation
+ * (revolute and fixed joints) plus the maximum extent of the joint (prismatic joints), so the sum of these bounds along
+ * the chain bounds the distance to the tip link
+ * @return False if the envelope cannot be bounded (e.g., unbounded prismatic or multi-DOF joints), true otherwise
+ */
+bool getWorkspaceEnvelope(const moveit::core::RobotModelConstPtr& model, const moveit::core::JointModelGroup* jmg,
+                          Eigen::Vector3d& center, double& radius)
+{
+  std::string tip_frame = jmg->getSolverInstance()->getTipFrame();
+  if (!tip_frame.empty() && tip_frame.front() == '/')
+    tip_frame.erase(0, 1);
+
+  const moveit::core::LinkModel* root = jmg->getActiveJointModels().front()->getParentLinkModel();
+  const moveit::core::LinkModel* link = model->getLinkModel(tip_frame);
+
+  radius = 0.0;
+  while (link && link != root)
+  {
+    radius += link->getJointOriginTransform().translation().norm();
+
+    const moveit::core::JointModel* joint = link->getParentJointModel();
+    switch (joint->getType())
+    {
+      case moveit::core::JointModel::FIXED:
+      case moveit::core::JointModel::REVOLUTE:
+        break;
+      case moveit::core::JointModel::PRISMATIC:
+      {
+        const moveit::core::VariableBounds& bounds = joint->getVariableBounds().front();
+        if (!bounds.position_bounded_)
+          return false;
+        radius += std::max(std::abs(bounds.min_position_), std::abs(bounds.max_position_));
+        break;
+      }
+      default:
+        return false;
+    }
+
+    link = link->getParentLinkModel();
+  }
+
+  // The tip link must be a descendant of the root link
+  if (!link)
+    return false;
+
+  // Allow for round-off in the forward kinematics
+  radius += 1.0e-6;
+
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+  state.update();
+  center = state.getGlobalLinkTransform(root).translation();
+
+  return true;
+}
+
+/**
+ * @brief Creates a collision environment on a world in which the robot links are padded by the input padding (e.g., the
+ * error of a simplified collision mesh), and the clearance links (or all links if there are none) are additionally
+ * padded by the clearance
+ */
+collision_detection::CollisionEnvPtr
+createPaddedEnv(const moveit::core::RobotModelConstPtr& model, const collision_detection::WorldPtr& world,
+                double padding, const std::set<const moveit::core::LinkModel*>& clearance_links = {},
+                double clearance = 0.0)
+{
+  if (clearance_links.empty())
+    return std::make_shared<collision_detection::CollisionEnvFCL>(model, world, padding + clearance);
+
+  auto env = std::make_shared<collision_detection::CollisionEnvFCL>(model, world, padding);
+  for (const moveit::core::LinkModel* link : clearance_links)
+    env->setLinkPadding(link->getName(), padding + clearance);
+  return env;
+}
+
+/** @brief Applies the optional configuration parameters common to all MoveIt IK solvers */
+void configure(reach_ros::ik::MoveItIKSolver& ik_solver, const YAML::Node& config)
+{
+  // Optionally add a collision mesh
+  const std::string collision_mesh_filename_key = "collision_mesh_filename";
+  const std::string collision_mesh_frame_key = "collision_mesh_key";
+  if (config[collision_mesh_filename_key])
+  {
+    auto collision_mesh_filename = reach::get<std::string>(config, collision_mesh_filename_key);
+    std::string collision_mesh_frame = config[collision_mesh_frame_key] ?
+                                           reach::get<std::string>(config, collision_mesh_frame_key) :
+                                           ik_solver.getKinematicBaseFrame();
+
+    ik_solver.addCollisionMesh(collision_mesh_filename, collision_mesh_frame,
+                               reach_ros::collision::getMeshDecimation(config));
+  }
+
+  // Optionally add touch links
+  const std::string touch_links_key = "touch_links";
+  if (config[touch_links_key])
+  {
+    auto touch_links = reach::get<std::vector<std::string>>(config, touch_links_key);
+    ik_solver.setTouchLinks(touch_links);
+  }
+
+  // Optionally skip self-collision checks of link pairs that never or always collide
+  const std::string self_collision_samples_key = "self_collision_samples";
+  if (config[self_collision_samples_key])
+    ik_solver.setSelfCollisionSampling(reach::get<std::size_t>(config, self_collision_samples_key));
+
+  // Optionally configure the signed distance field of the collision mesh
+  const std::string sdf_resolution_key = "sdf_resolution";
+  const std::string sdf_max_distance_key = "sdf_max_distance";
+  if (config[sdf_resolution_key] || config[sdf_max_distance_key])
+  {
+    double resolution = config[sdf_resolution_key] ? reach::get<double>(config, sdf_resolution_key) : 0.01;
+    double max_distance = config[sdf_max_distance_key] ? reach::get<double>(config, sdf_max_distance_key) : 0.0;
+    ik_solver.setSignedDistanceField(resolution, max_distance);
+  }
+
+  // Optionally restrict the clearance check to a subset of the links
+  const std::string clearance_links_key = "clearance_links";
+  if (config[clearance_links_key])
+    ik_solver.setClearanceLinks(reach::get<std::vector<std::string>>(config, clearance_links_key));
+
+  ik_solver.setClearanceMode(reach_ros::collision::getClearanceMode(config));
+  ik_solver.setCollisionScope(
+      reach_ros::collision::getCollisionScope(config, reach_ros::collision::CollisionScope::BOTH));
+
+  // Optionally decide most collision checks against the collision mesh from its signed distance field
+  const std::string collision_precheck_key = "collision_precheck";
+  if (config[collision_precheck_key])
+    ik_solver.setCollisionPrecheck(reach::get<bool>(config, collision_precheck_key));
+
+  // Optionally collect multiple distinct solutions per target
+  const std::string max_solutions_key = "max_solutions";
+  const std::string solution_tolerance_key = "solution_tolerance";
+  if (config[max_solutions_key])
+  {
+    double solution_tolerance =
+        config[solution_tolerance_key] ? reach::get<double>(config, solution_tolerance_key) : 1.0e-3;
+    ik_solver.setMaxSolutions(reach::get<std::size_t>(config, max_solutions_key), solution_tolerance);
+  }
+
+  const std::string n_random_seeds_key = "n_random_seeds";
+  if (config[n_random_seeds_key])
+    ik_solver.setNumRandomSeeds(reach::get<std::size_t>(config, n_random_seeds_key));
+
+  // Optionally add named states as additional seeds
+  const std::string seed_states_key = "seed_states";
+  if (config[seed_states_key])
+    ik_solver.setSeedStates(reach::get<std::vector<std::string>>(config, seed_states_key));
+
+  // Optionally race the seeds in parallel
+  const std::string n_seed_threads_key = "seed_threads";
+  if (config[n_seed_threads_key])
+    ik_solver.setNumSeedThreads(reach::get<std::size_t>(config, n_seed_threads_key));
+
+  // Optionally warm-start the solver from the solutions of nearby, previously solved targets
+  const std::string seed_cache_resolution_key = "seed_cache_resolution";
+  const std::string seed_cache_neighbors_key = "seed_cache_neighbors";
+  if (config[seed_cache_resolution_key])
+  {
+    std::size_t n_neighbors =
+        config[seed_cache_neighbors_key] ? reach::get<std::size_t>(config, seed_cache_neighbors_key) : 3;
+    ik_solver.setSeedCache(reach::get<double>(config, seed_cache_resolution_key), n_neighbors);
+  }
+
+  // Optionally disable the workspace envelope
+  const std::string use_workspace_envelope_key = "use_workspace_envelope";
+  if (config[use_workspace_envelope_key])
+    ik_solver.setWorkspaceEnvelope(reach::get<bool>(config, use_workspace_envelope_key));
+}
+
 }  // namespace
 
 namespace reach_ros
@@ -38,14 +285,110 @@ namespace ik
 {
 std::string MoveItIKSolver::COLLISION_OBJECT_NAME = "reach_object";
 
+struct MoveItIKSolver::Context
+{
+  Context(const moveit::core::RobotModelConstPtr& model, const moveit::core::JointModelGroup* jmg) : state(model)
+  {
+    state.setToDefaultValues();
+
+    // Kinematics plugins (e.g., KDL) keep mutable internal state, so each thread gets its own solver instance rather
+    // than sharing the instance owned by the joint model group
+    const auto& allocators = jmg->getSolverAllocators();
+    if (allocators.first)
+      solver = allocators.first(jmg);
+    else
+      solver = jmg->getSolverInstance();
+
+    if (!solver)
+      throw std::runtime_error("Failed to allocate a kinematics solver for planning group '" + jmg->getName() + "'");
+  }
+
+  /**
+   * @brief Resets the planning group joints of the robot state and the kinematics solver seed with the input seed
+   * @return The input target (in the model frame) expressed in the base frame of the kinematics solver, as
+   * RobotState::setFromIK does
+   */
+  geometry_msgs::Pose setSeed(const moveit::core::JointModelGroup* jmg, const Eigen::Isometry3d& target,
+                              const std::vector<double>& group_seed)
+  {
+    // Only the joints of the planning group are ever modified, so resetting them fully restores the state
+    state.setJointGroupPositions(jmg, group_seed);
+    state.update();
+
+    // Map from the joint order of the planning group to the joint order of the kinematics solver
+    const std::vector<unsigned int>& bijection = jmg->getKinematicsSolverJointBijection();
+    ik_seed.resize(bijection.size());
+    for (std::size_t i = 0; i < bijection.size(); ++i)
+      ik_seed[i] = group_seed[bijection[i]];
+
+    Eigen::Isometry3d ik_target = target;
+    std::string base_frame = solver->getBaseFrame();
+    if (!base_frame.empty() && base_frame.front() == '/')
+      base_frame.erase(0, 1);
+    if (base_frame != state.getRobotModel()->getModelFrame())
+      ik_target = state.getGlobalLinkTransform(base_frame).inverse() * ik_target;
+
+    geometry_msgs::Pose ik_target_msg;
+    tf::poseEigenToMsg(ik_target, ik_target_msg);
+    return ik_target_msg;
+  }
+
+  moveit::core::RobotState state;
+  kinematics::KinematicsBaseConstPtr solver;
+
+  // Buffers for the seed and solution, in the joint order of the planning group
+  std::vector<double> seed;
+  std::vector<double> solution;
+
+  // Buffers for the seed and solution, in the joint order of the kinematics solver
+  std::vector<double> ik_seed;
+  std::vector<double> ik_solution;
+
+  // Validity check counters; only written by the owning thread, but read by others when reporting statistics
+  std::atomic<std::size_t> n_checked{ 0 };
+  std::atomic<std::size_t> n_joint_limit_rejections{ 0 };
+  std::atomic<std::size_t> n_collision_rejections{ 0 };
+  std::atomic<std::size_t> n_clearance_rejections{ 0 };
+  std::atomic<std::size_t> n_precheck_free{ 0 };
+  std::atomic<std::size_t> n_precheck_colliding{ 0 };
+};
+
 MoveItIKSolver::MoveItIKSolver(moveit::core::RobotModelConstPtr model, const std::string& planning_group,
                                double dist_threshold)
-  : model_(model), jmg_(model_->getJointModelGroup(planning_group)), distance_threshold_(dist_threshold)
+  : model_(model)
+  , jmg_(model_->getJointModelGroup(planning_group))
+  , distance_threshold_(dist_threshold)
+  , clearance_mode_(ClearanceMode::DISTANCE)
+  , collision_scope_(collision::CollisionScope::BOTH)
+  , mesh_error_(0.0)
+  , coarse_error_(0.0)
+  , sdf_resolution_(0.01)
+  , sdf_max_distance_(0.0)
+  , use_collision_precheck_(false)
+  , max_solutions_(1)
+  , solution_tolerance_(1.0e-3)
+  , n_random_seeds_(0)
+  , n_seed_threads_(1)
+  , n_seed_cache_neighbors_(0)
+  , use_workspace_envelope_(true)
+  , envelope_center_(Eigen::Vector3d::Zero())
+  , envelope_radius_(-1.0)
+  , n_envelope_rejections_(0)
 {
   if (!jmg_)
     throw std::runtime_error("Failed to initialize joint model group for planning group '" + planning_group + "'");
 
+  // The workspace envelope, the wrist-axis shortcut, and the per-thread solver instances all depend on the kinematics
+  // solver of the planning group
+  if (!jmg_->getSolverInstance())
+    throw std::runtime_error("No kinematics solver is configured for planning group '" + planning_group + "'");
+
+  if (!getWorkspaceEnvelope(model_, jmg_, envelope_center_, envelope_radius_))
+    envelope_radius_ = -1.0;
+
   scene_.reset(new planning_scene::PlanningScene(model_));
+  world_env_ = scene_->getCollisionEnv();
+  distance_query_key_ = utils::getDistanceQueryKey(*scene_, clearance_links_);
 
   ros::NodeHandle nh;
   scene_pub_ = nh.advertise<moveit_msgs::PlanningScene>("planning_scene", 1, true);
@@ -54,39 +397,324 @@ MoveItIKSolver::MoveItIKSolver(moveit::core::RobotModelConstPtr model, const std
   scene_pub_.publish(scene_msg);
 }
 
+MoveItIKSolver::~MoveItIKSolver()
+{
+  const ValidityStatistics stats = getValidityStatistics();
+  if (stats.checked > 0)
+  {
+    ROS_INFO_STREAM("IK solution validity checks: " << stats.checked << " checked, "
+                                                    << stats.joint_limit_rejections << " rejected by joint limits, "
+                                                    << stats.collision_rejections << " rejected by collision, "
+                                                    << stats.clearance_rejections << " rejected by clearance");
+  }
+
+  if (stats.envelope_rejections > 0)
+    ROS_INFO_STREAM("IK targets rejected by the workspace envelope: " << stats.envelope_rejections);
+
+  if (collision_precheck_ && stats.checked > 0)
+  {
+    ROS_INFO_STREAM("Collision pre-check: " << stats.precheck_free << " decided free, " << stats.precheck_colliding
+                                            << " decided colliding");
+  }
+}
+
 std::vector<std::vector<double>> MoveItIKSolver::solveIK(const Eigen::Isometry3d& target,
                                                          const std::map<std::string, double>& seed) const
 {
-  moveit::core::RobotState state(model_);
+  if (!isWithinWorkspaceEnvelope(target))
+    return {};
 
-  const std::vector<std::string>& joint_names = jmg_->getActiveJointModelNames();
+  // Re-use this thread's context rather than allocating a new robot state and kinematics solver
+  Context& ctx = getContext();
+  ctx.seed = utils::transcribeInputMap(seed, jmg_->getActiveJointModelNames());
 
-  std::vector<double> seed_subset = utils::transcribeInputMap(seed, joint_names);
-  state.setJointGroupPositions(jmg_, seed_subset);
-  state.update();
+  // Collect distinct solutions, merging those within the joint-space tolerance of an existing solution
+  std::vector<std::vector<double>> solutions;
+  std::mutex solutions_mutex;
+  std::atomic<bool> finished{ false };
+  auto add = [this, &solutions, &solutions_mutex, &finished](const std::vector<double>& solution) {
+    std::lock_guard<std::mutex> lock(solutions_mutex);
+    const bool duplicate =
+        std::any_of(solutions.begin(), solutions.end(), [this, &solution](const std::vector<double>& existing) {
+          for (std::size_t i = 0; i < solution.size(); ++i)
+          {
+            if (std::abs(solution[i] - existing[i]) > solution_tolerance_)
+              return false;
+          }
+          return true;
+        });
+
+    if (!duplicate && solutions.size() < max_solutions_)
+      solutions.push_back(solution);
+
+    if (solutions.size() >= max_solutions_)
+      finished = true;
+  };
+
+  // Kinematics plugins that support multiple solutions (e.g., IKFast) can return all of them in a single query
+  if (max_solutions_ > 1)
+  {
+    std::vector<std::vector<double>> candidates;
+    if (searchAllIK(ctx, target, ctx.seed, candidates))
+      std::for_each(candidates.begin(), candidates.end(), add);
+  }
 
-  if (state.setFromIK(jmg_, target, 0.0, boost::bind(&MoveItIKSolver::isIKSolutionValid, this, _1, _2, _3)))
+  // Solve from the solutions of nearby cached targets, then the input seed, then the named seed states, then random
+  // seeds
+  std::vector<std::vector<double>> seeds;
+  if (seed_cache_)
+    seeds = seed_cache_->getSeeds(target, n_seed_cache_neighbors_);
+  seeds.reserve(seeds.size() + 1 + seed_states_.size() + n_random_seeds_);
+  seeds.push_back(ctx.seed);
+  seeds.insert(seeds.end(), seed_states_.begin(), seed_states_.end());
+  for (std::size_t i = 0; i < n_random_seeds_; ++i)
   {
+    ctx.state.setToRandomPositions(jmg_);
+    seeds.emplace_back();
+    ctx.state.copyJointGroupPositions(jmg_, seeds.back());
+  }
+
+  // Race the seeds across threads; once enough solutions have been found, attempts that have not started are skipped
+  // and attempts in progress are cancelled
+  utils::parallelFor(seeds.size(), n_seed_threads_, [&](std::size_t i) {
+    if (finished)
+      return false;
+
     std::vector<double> solution;
-    state.copyJointGroupPositions(jmg_, solution);
+    if (searchIK(getContext(), target, seeds[i], solution, &finished))
+      add(solution);
+
+    return !finished;
+  });
+
+  if (seed_cache_ && !solutions.empty())
+    seed_cache_->insert(target, solutions.front());
+
+  return solutions;
+}
+
+MoveItIKSolver::Context& MoveItIKSolver::getContext() const
+{
+  std::lock_guard<std::mutex> lock(context_mutex_);
+  std::shared_ptr<Context>& ctx = contexts_[std::this_thread::get_id()];
+  if (!ctx)
+    ctx = std::make_shared<Context>(model_, jmg_);
+
+  return *ctx;
+}
+
+bool MoveItIKSolver::searchIK(Context& ctx, const Eigen::Isometry3d& target, const std::vector<double>& seed,
+                              std::vector<double>& solution, const std::atomic<bool>* cancel) const
+{
+  const geometry_msgs::Pose ik_target = ctx.setSeed(jmg_, target, seed);
+
+  const std::vector<unsigned int>& bijection = jmg_->getKinematicsSolverJointBijection();
+  ctx.solution.resize(bijection.size());
+  auto callback = [this, &ctx, &bijection, cancel](const geometry_msgs::Pose&, const std::vector<double>& ik_solution,
+                                                   moveit_msgs::MoveItErrorCodes& error_code) {
+    // Kinematics solvers cannot be interrupted, but accepting the candidate makes the solver return immediately
+    if (cancel && *cancel)
+    {
+      error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+      return;
+    }
+
+    for (std::size_t i = 0; i < bijection.size(); ++i)
+      ctx.solution[bijection[i]] = ik_solution[i];
+
+    error_code.val = isIKSolutionValid(ctx, &ctx.state, jmg_, ctx.solution.data()) ?
+                         moveit_msgs::MoveItErrorCodes::SUCCESS :
+                         moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+  };
+
+  moveit_msgs::MoveItErrorCodes error_code;
+  if (!ctx.solver->searchPositionIK(ik_target, ctx.ik_seed, jmg_->getDefaultIKTimeout(), ctx.ik_solution, callback,
+                                    error_code))
+    return false;
+
+  if (cancel && *cancel)
+    return false;
+
+  solution.resize(bijection.size());
+  for (std::size_t i = 0; i < bijection.size(); ++i)
+    solution[bijection[i]] = ctx.ik_solution[i];
+
+  return true;
+}
+
+bool MoveItIKSolver::searchAllIK(Context& ctx, const Eigen::Isometry3d& target, const std::vector<double>& seed,
+                                 std::vector<std::vector<double>>& solutions) const
+{
+  const geometry_msgs::Pose ik_target = ctx.setSeed(jmg_, target, seed);
 
-    return { solution };
+  std::vector<std::vector<double>> ik_solutions;
+  kinematics::KinematicsResult result;
+  kinematics::KinematicsQueryOptions options;
+  if (!ctx.solver->getPositionIK({ ik_target }, ctx.ik_seed, ik_solutions, result, options))
+    return false;
+
+  // The kinematics solver does not check the validity of these solutions
+  const std::vector<unsigned int>& bijection = jmg_->getKinematicsSolverJointBijection();
+  for (const std::vector<double>& ik_solution : ik_solutions)
+  {
+    std::vector<double> solution(bijection.size());
+    for (std::size_t i = 0; i < bijection.size(); ++i)
+      solution[bijection[i]] = ik_solution[i];
+
+    if (isIKSolutionValid(ctx, &ctx.state, jmg_, solution.data()))
+      solutions.push_back(std::move(solution));
   }
 
-  return {};
+  return true;
 }
 
-bool MoveItIKSolver::isIKSolutionValid(moveit::core::RobotState* state, const moveit::core::JointModelGroup* jmg,
-                                       const double* ik_solution) const
+bool MoveItIKSolver::isIKSolutionValid(Context& ctx, moveit::core::RobotState* state,
+                                       const moveit::core::JointModelGroup* jmg, const double* ik_solution) const
 {
+  ctx.n_checked.fetch_add(1, std::memory_order_relaxed);
   state->setJointGroupPositions(jmg, ik_solution);
+
+  // Joint limits can be checked without updating the link transforms
+  if (!state->satisfiesBounds(jmg))
+  {
+    ctx.n_joint_limit_rejections.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
   state->update();
 
-  const bool colliding = scene_->isStateColliding(*state, jmg->getName(), false);
-  const bool too_close =
-      (scene_->distanceToCollision(*state, scene_->getAllowedCollisionMatrix()) < distance_threshold_);
+  if (isStateColliding(ctx, *state, jmg))
+  {
+    ctx.n_collision_rejections.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // The clearance check is by far the most expensive check, so only run it when a positive threshold requires it
+  if (distance_threshold_ > 0.0 && collision::includesWorld(collision_scope_))
+  {
+    const collision_detection::AllowedCollisionMatrix& acm = scene_->getAllowedCollisionMatrix();
+
+    auto getClearance = [&](const collision_detection::CollisionEnv& env) {
+      return utils::getDistanceToWorld(env, *state, acm, clearance_links_);
+    };
+
+    // The links are padded by the error of the coarse mesh, so clearance from the coarse mesh implies clearance from
+    // the full mesh. Distances to the full mesh are memoized, since the distance penalty evaluator often scores the
+    // same state
+    bool too_close;
+    switch (clearance_mode_)
+    {
+      case ClearanceMode::PADDING:
+      {
+        collision_detection::CollisionRequest req;
+        collision_detection::CollisionResult res;
+        if (coarse_padded_env_)
+        {
+          coarse_padded_env_->checkRobotCollision(req, res, *state, acm);
+          if (!res.collision)
+          {
+            too_close = false;
+            break;
+          }
+          res.clear();
+        }
+
+        padded_env_->checkRobotCollision(req, res, *state, acm);
+        too_close = res.collision;
+        break;
+      }
+      case ClearanceMode::SDF:
+        too_close = sdf_ && !link_spheres_->isClearOf(*state, *sdf_, distance_threshold_);
+        break;
+      default:
+        too_close = !(coarse_env_ && getClearance(*coarse_env_) >= distance_threshold_) &&
+                    utils::memoizeDistance(distance_query_key_, *state, std::numeric_limits<double>::max(), [&] {
+                      return getClearance(*world_env_);
+                    }) < distance_threshold_;
+        break;
+    }
+
+    if (too_close)
+    {
+      ctx.n_clearance_rejections.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool MoveItIKSolver::isStateColliding(Context& ctx, const moveit::core::RobotState& state,
+                                      const moveit::core::JointModelGroup* jmg) const
+{
+  const collision_detection::AllowedCollisionMatrix& acm = scene_->getAllowedCollisionMatrix();
+  collision_detection::CollisionRequest req;
+  req.group_name = jmg->getName();
+  collision_detection::CollisionResult res;
+
+  if (collision::includesWorld(collision_scope_))
+  {
+    // States that the pre-check or the coarse mesh (against which the links are padded by its error) decide to be free
+    // of collision with the collision mesh are not checked against the full mesh. The other objects of the world (if
+    // any) are still checked
+    bool check_mesh = true;
+    const bool check_other_objects = other_objects_acm_ && scene_->getWorld()->size() > 1;
+    if (collision_precheck_)
+    {
+      switch (collision_precheck_->check(state))
+      {
+        case collision::CollisionPrecheck::Result::COLLIDING:
+          ctx.n_precheck_colliding.fetch_add(1, std::memory_order_relaxed);
+          return true;
+        case collision::CollisionPrecheck::Result::FREE:
+          ctx.n_precheck_free.fetch_add(1, std::memory_order_relaxed);
+          check_mesh = false;
+          break;
+        default:
+          break;
+      }
+    }
+
+    if (check_mesh && coarse_env_)
+    {
+      coarse_env_->checkRobotCollision(req, res, state, acm);
+      check_mesh = res.collision;
+      res.clear();
+    }
+
+    if (check_mesh)
+    {
+      world_env_->checkRobotCollision(req, res, state, acm);
+      if (res.collision)
+        return true;
+    }
+    else if (check_other_objects)
+    {
+      world_env_->checkRobotCollision(req, res, state, *other_objects_acm_);
+      if (res.collision)
+        return true;
+    }
+  }
+
+  if (collision::includesSelf(collision_scope_))
+  {
+    scene_->checkSelfCollision(req, res, state, acm);
+    return res.collision;
+  }
+
+  return false;
+}
+
+bool MoveItIKSolver::isWithinWorkspaceEnvelope(const Eigen::Isometry3d& target) const
+{
+  if (!use_workspace_envelope_ || envelope_radius_ < 0.0)
+    return true;
+
+  if ((target.translation() - envelope_center_).norm() <= envelope_radius_)
+    return true;
 
-  return (!colliding && !too_close);
+  n_envelope_rejections_.fetch_add(1, std::memory_order_relaxed);
+  return false;
 }
 
 std::vector<std::string> MoveItIKSolver::getJointNames() const
@@ -95,13 +723,40 @@ std::vector<std::string> MoveItIKSolver::getJointNames() const
 }
 
 void MoveItIKSolver::addCollisionMesh(const std::string& collision_mesh_filename,
-                                      const std::string& collision_mesh_frame)
+                                      const std::string& collision_mesh_frame,
+                                      const collision::MeshDecimation& decimation)
 {
-  // Add the collision object to the planning scene
-  moveit_msgs::CollisionObject obj =
-      utils::createCollisionObject(collision_mesh_filename, collision_mesh_frame, COLLISION_OBJECT_NAME);
-  if (!scene_->processCollisionObjectMsg(obj))
-    throw std::runtime_error("Failed to add collision mesh to planning scene");
+  // With a coarse/fine pair, the scene uses the full mesh and the simplified mesh is kept separately for pre-checks
+  const bool coarse_fine = decimation.enabled() && decimation.coarse_fine;
+  scene_decimation_ = coarse_fine ? collision::MeshDecimation() : decimation;
+
+  // Re-create the planning scene on the shared collision world of the mesh, keeping the allowed collision matrix
+  planning_scene::PlanningScenePtr scene(new planning_scene::PlanningScene(
+      model_, utils::getCollisionWorld(model_, collision_mesh_filename, collision_mesh_frame, COLLISION_OBJECT_NAME,
+                                       scene_decimation_, &mesh_error_)));
+  scene->getAllowedCollisionMatrixNonConst() = scene_->getAllowedCollisionMatrix();
+  scene_ = scene;
+  world_env_ = mesh_error_ > 0.0 ? createPaddedEnv(model_, scene_->getWorldNonConst(), mesh_error_) :
+                                   scene_->getCollisionEnv();
+  distance_query_key_ = utils::getDistanceQueryKey(*scene_, clearance_links_);
+  collision_mesh_filename_ = collision_mesh_filename;
+  collision_mesh_frame_ = collision_mesh_frame;
+
+  if (coarse_fine)
+  {
+    coarse_world_ = utils::getCollisionWorld(model_, collision_mesh_filename, collision_mesh_frame,
+                                             COLLISION_OBJECT_NAME, decimation, &coarse_error_);
+    coarse_env_ = createPaddedEnv(model_, coarse_world_, coarse_error_);
+  }
+  else
+  {
+    coarse_world_.reset();
+    coarse_env_.reset();
+    coarse_error_ = 0.0;
+  }
+
+  // Re-create the padded collision environments on the new worlds, or the signed distance field of the new mesh
+  setClearanceMode(clearance_mode_);
 
   moveit_msgs::PlanningScene scene_msg;
   scene_->getPlanningSceneMsg(scene_msg);
@@ -111,6 +766,190 @@ void MoveItIKSolver::addCollisionMesh(const std::string& collision_mesh_filename
 void MoveItIKSolver::setTouchLinks(const std::vector<std::string>& touch_links)
 {
   scene_->getAllowedCollisionMatrixNonConst().setEntry(COLLISION_OBJECT_NAME, touch_links, true);
+  distance_query_key_ = utils::getDistanceQueryKey(*scene_, clearance_links_);
+
+  // Re-create the link spheres, which exclude the touch links
+  updateSignedDistanceField();
+}
+
+void MoveItIKSolver::setClearanceMode(ClearanceMode mode)
+{
+  clearance_mode_ = mode;
+
+  // The padded environment shares the world of the planning scene, so it stays in sync with the collision mesh. Only
+  // the clearance links are padded by the distance threshold; the other links have already been checked for collision
+  if (clearance_mode_ == ClearanceMode::PADDING)
+    padded_env_ =
+        createPaddedEnv(model_, scene_->getWorldNonConst(), mesh_error_, clearance_links_, distance_threshold_);
+  else
+    padded_env_.reset();
+
+  if (clearance_mode_ == ClearanceMode::PADDING && coarse_world_)
+    coarse_padded_env_ = createPaddedEnv(model_, coarse_world_, coarse_error_, clearance_links_, distance_threshold_);
+  else
+    coarse_padded_env_.reset();
+
+  updateSignedDistanceField();
+}
+
+void MoveItIKSolver::setCollisionScope(collision::CollisionScope scope)
+{
+  collision_scope_ = scope;
+}
+
+void MoveItIKSolver::setClearanceLinks(const std::vector<std::string>& clearance_links)
+{
+  clearance_links_ = utils::getLinkModels(model_, clearance_links);
+  distance_query_key_ = utils::getDistanceQueryKey(*scene_, clearance_links_);
+
+  // Re-create the padded collision environments and the link spheres for the new links
+  setClearanceMode(clearance_mode_);
+}
+
+void MoveItIKSolver::updateSignedDistanceField()
+{
+  // States that the pre-check or the coarse mesh decide to be free of collision with the collision mesh are checked
+  // against the other objects of the world with the collisions with the mesh allowed
+  if (!collision_mesh_filename_.empty() && (use_collision_precheck_ || coarse_env_))
+  {
+    auto other_objects_acm =
+        std::make_shared<collision_detection::AllowedCollisionMatrix>(scene_->getAllowedCollisionMatrix());
+    other_objects_acm->setEntry(COLLISION_OBJECT_NAME, model_->getLinkModelNamesWithCollisionGeometry(), true);
+    other_objects_acm_ = other_objects_acm;
+  }
+  else
+  {
+    other_objects_acm_.reset();
+  }
+
+  const bool use_sdf = clearance_mode_ == ClearanceMode::SDF || use_collision_precheck_;
+  if (!use_sdf || collision_mesh_filename_.empty())
+  {
+    sdf_.reset();
+    link_spheres_.reset();
+    collision_precheck_.reset();
+    return;
+  }
+
+  // Fetch the fields while still holding the current ones, such that unchanged fields are re-used from the registry
+  // rather than rebuilt. The clearance is measured from the original mesh, whereas the pre-check must agree with the
+  // exact check against the mesh of the planning scene
+  const double max_distance = std::max(sdf_max_distance_, distance_threshold_ + 2.0 * sdf_resolution_);
+  std::shared_ptr<const collision::SignedDistanceField> sdf;
+  if (clearance_mode_ == ClearanceMode::SDF)
+    sdf = utils::getSignedDistanceField(model_, collision_mesh_filename_, collision_mesh_frame_, sdf_resolution_,
+                                        max_distance);
+  std::shared_ptr<const collision::SignedDistanceField> precheck_sdf;
+  if (use_collision_precheck_)
+    precheck_sdf = scene_decimation_.enabled() || !sdf ?
+                       utils::getSignedDistanceField(model_, collision_mesh_filename_, collision_mesh_frame_,
+                                                     sdf_resolution_, max_distance, scene_decimation_) :
+                       sdf;
+
+  // Links that are allowed to touch the collision mesh are not checked against it
+  const collision_detection::AllowedCollisionMatrix& acm = scene_->getAllowedCollisionMatrix();
+  std::vector<std::string> touch_links;
+  for (const moveit::core::LinkModel* link : model_->getLinkModelsWithCollisionGeometry())
+  {
+    collision_detection::AllowedCollision::Type type;
+    if (acm.getEntry(COLLISION_OBJECT_NAME, link->getName(), type) &&
+        type == collision_detection::AllowedCollision::ALWAYS)
+      touch_links.push_back(link->getName());
+  }
+
+  std::shared_ptr<const collision::LinkSpheres> link_spheres;
+  if (clearance_mode_ == ClearanceMode::SDF)
+  {
+    // Links whose clearance is not checked need no spheres either
+    std::vector<std::string> excluded_links = touch_links;
+    if (!clearance_links_.empty())
+    {
+      for (const moveit::core::LinkModel* link : jmg_->getUpdatedLinkModelsWithGeometry())
+        if (!clearance_links_.count(link))
+          excluded_links.push_back(link->getName());
+    }
+
+    link_spheres = std::make_shared<collision::LinkSpheres>(jmg_, excluded_links);
+  }
+
+  // The links are padded by the error of the mesh of the planning scene in the exact check
+  std::shared_ptr<const collision::CollisionPrecheck> collision_precheck;
+  if (use_collision_precheck_)
+    collision_precheck = std::make_shared<collision::CollisionPrecheck>(precheck_sdf, jmg_, touch_links, mesh_error_);
+
+  sdf_ = sdf;
+  link_spheres_ = link_spheres;
+  collision_precheck_ = collision_precheck;
+}
+
+void MoveItIKSolver::setMaxSolutions(std::size_t max_solutions, double solution_tolerance)
+{
+  max_solutions_ = std::max<std::size_t>(max_solutions, 1);
+  solution_tolerance_ = std::abs(solution_tolerance);
+}
+
+void MoveItIKSolver::setNumRandomSeeds(std::size_t n_random_seeds)
+{
+  n_random_seeds_ = n_random_seeds;
+}
+
+void MoveItIKSolver::setSeedStates(const std::vector<std::string>& seed_states)
+{
+  seed_states_.clear();
+  for (const std::string& name : seed_states)
+  {
+    std::map<std::string, double> positions;
+    if (!jmg_->getVariableDefaultPositions(name, positions))
+      throw std::runtime_error("Planning group '" + jmg_->getName() + "' has no named state '" + name + "'");
+
+    seed_states_.push_back(utils::transcribeInputMap(positions, jmg_->getActiveJointModelNames()));
+  }
+}
+
+void MoveItIKSolver::setNumSeedThreads(std::size_t n_seed_threads)
+{
+  n_seed_threads_ = std::max<std::size_t>(n_seed_threads, 1);
+}
+
+void MoveItIKSolver::setSeedCache(double resolution, std::size_t n_neighbors)
+{
+  if (resolution > 0.0 && n_neighbors > 0)
+    seed_cache_ = std::make_shared<SeedCache>(resolution);
+  else
+    seed_cache_.reset();
+
+  n_seed_cache_neighbors_ = n_neighbors;
+}
+
+void MoveItIKSolver::setWorkspaceEnvelope(bool use_workspace_envelope)
+{
+  use_workspace_envelope_ = use_workspace_envelope;
+}
+
+void MoveItIKSolver::setSignedDistanceField(double resolution, double max_distance)
+{
+  if (resolution <= 0.0)
+    throw std::runtime_error("Signed distance field resolution must be positive");
+
+  sdf_resolution_ = resolution;
+  sdf_max_distance_ = max_distance;
+  updateSignedDistanceField();
+}
+
+void MoveItIKSolver::setCollisionPrecheck(bool use_collision_precheck)
+{
+  use_collision_precheck_ = use_collision_precheck;
+  updateSignedDistanceField();
+}
+
+void MoveItIKSolver::setSelfCollisionSampling(std::size_t n_samples)
+{
+  if (n_samples == 0)
+    return;
+
+  std::shared_ptr<const collision::SampledCollisions> collisions = utils::getSampledSelfCollisions(
+      model_, jmg_->getName(), n_samples, std::max<std::size_t>(std::thread::hardware_concurrency(), 1));
+  collisions->apply(scene_->getAllowedCollisionMatrixNonConst());
 }
 
 std::string MoveItIKSolver::getKinematicBaseFrame() const
@@ -118,6 +957,37 @@ std::string MoveItIKSolver::getKinematicBaseFrame() const
   return jmg_->getSolverInstance()->getBaseFrame();
 }
 
+std::uint64_t MoveItIKSolver::getKinematicsHash() const
+{
+  // Separate the names with null characters, such that they cannot run into each other
+  const kinematics::KinematicsBaseConstPtr& solver = jmg_->getSolverInstance();
+  std::string key;
+  for (const std::string& name : { model_->getName(), jmg_->getName(), solver->getBaseFrame(), solver->getTipFrame() })
+    key += name + '\0';
+
+  return utils::hashBytes(key.data(), key.size());
+}
+
+MoveItIKSolver::ValidityStatistics MoveItIKSolver::getValidityStatistics() const
+{
+  ValidityStatistics stats;
+  stats.envelope_rejections = n_envelope_rejections_.load(std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(context_mutex_);
+  for (const auto& pair : contexts_)
+  {
+    const Context& ctx = *pair.second;
+    stats.checked += ctx.n_checked.load(std::memory_order_relaxed);
+    stats.joint_limit_rejections += ctx.n_joint_limit_rejections.load(std::memory_order_relaxed);
+    stats.collision_rejections += ctx.n_collision_rejections.load(std::memory_order_relaxed);
+    stats.clearance_rejections += ctx.n_clearance_rejections.load(std::memory_order_relaxed);
+    stats.precheck_free += ctx.n_precheck_free.load(std::memory_order_relaxed);
+    stats.precheck_colliding += ctx.n_precheck_colliding.load(std::memory_order_relaxed);
+  }
+
+  return stats;
+}
+
 reach::IKSolver::ConstPtr MoveItIKSolverFactory::create(const YAML::Node& config) const
 {
   auto planning_group = reach::get<std::string>(config, "planning_group");
@@ -129,27 +999,7 @@ reach::IKSolver::ConstPtr MoveItIKSolverFactory::create(const YAML::Node& config
     throw std::runtime_error("Failed to initialize robot model pointer");
 
   auto ik_solver = std::make_shared<MoveItIKSolver>(model, planning_group, dist_threshold);
-
-  // Optionally add a collision mesh
-  const std::string collision_mesh_filename_key = "collision_mesh_filename";
-  const std::string collision_mesh_frame_key = "collision_mesh_key";
-  if (config[collision_mesh_filename_key])
-  {
-    auto collision_mesh_filename = reach::get<std::string>(config, collision_mesh_filename_key);
-    std::string collision_mesh_frame = config[collision_mesh_frame_key] ?
-                                           reach::get<std::string>(config, collision_mesh_frame_key) :
-                                           ik_solver->getKinematicBaseFrame();
-
-    ik_solver->addCollisionMesh(collision_mesh_filename, collision_mesh_frame);
-  }
-
-  // Optionally add touch links
-  const std::string touch_links_key = "touch_links";
-  if (config[touch_links_key])
-  {
-    auto touch_links = reach::get<std::vector<std::string>>(config, touch_links_key);
-    ik_solver->setTouchLinks(touch_links);
-  }
+  configure(*ik_solver, config);
 
   return ik_solver;
 }
@@ -157,31 +1007,182 @@ reach::IKSolver::ConstPtr MoveItIKSolverFactory::create(const YAML::Node& config
 DiscretizedMoveItIKSolver::DiscretizedMoveItIKSolver(moveit::core::RobotModelConstPtr model,
                                                      const std::string& planning_group, double dist_threshold,
                                                      double dt)
-  : MoveItIKSolver(model, planning_group, dist_threshold), dt_(dt)
+  : MoveItIKSolver(model, planning_group, dist_threshold)
+  , dt_(dt)
+  , n_discretizations_(int((2.0 * M_PI) / dt_))  // Number of discretizations necessary to achieve discretization angle
+  , n_threads_(1)
+  , max_discretized_solutions_(0)
+  , continuation_(false)
+  , adaptive_(false)
+  , coarse_dt_(M_PI / 4.0)
+  , wrist_axis_sign_(getWristAxisSign(model_, jmg_))
+  , wrist_axis_shortcut_(false)
 {
 }
 
 std::vector<std::vector<double>> DiscretizedMoveItIKSolver::solveIK(const Eigen::Isometry3d& target,
                                                                     const std::map<std::string, double>& seed) const
 {
-  // Calculate the number of discretizations necessary to achieve discretization angle
-  const static int n_discretizations = int((2.0 * M_PI) / dt_);
+  // Rotating the target about its Z-axis does not change its position, so no discretization can be within reach
+  if (!isWithinWorkspaceEnvelope(target))
+    return {};
 
-  std::vector<std::vector<double>> solutions;
-  solutions.reserve(n_discretizations);
+  const std::vector<double> seed_subset = utils::transcribeInputMap(seed, jmg_->getActiveJointModelNames());
 
-  for (int i = 0; i < n_discretizations; ++i)
-  {
+  // Solutions are stored by discretization index, such that they can be solved in any order
+  std::vector<std::vector<double>> solutions(n_discretizations_);
+  std::atomic<std::size_t> n_solutions{ 0 };
+  auto solve = [&](Context& ctx, std::size_t i, const std::vector<double>& discretization_seed) {
     Eigen::Isometry3d discretized_target(target * Eigen::AngleAxisd(double(i) * dt_, Eigen::Vector3d::UnitZ()));
-    std::vector<std::vector<double>> tmp_sols = MoveItIKSolver::solveIK(discretized_target, seed);
+    if (!searchIK(ctx, discretized_target, discretization_seed, solutions[i]))
+      return false;
+
+    ++n_solutions;
+    return true;
+  };
+
+  // Checks whether the requested number of feasible discretizations has been found
+  auto done = [&]() { return max_discretized_solutions_ > 0 && n_solutions >= max_discretized_solutions_; };
+
+  if (wrist_axis_shortcut_ && wrist_axis_sign_ != 0)
+  {
+    // Fully solve the discretizations in order until one succeeds
+    Context& base_ctx = getContext();
+    std::size_t base = 0;
+    while (base < solutions.size() && !solve(base_ctx, base, seed_subset))
+      ++base;
+
+    // Generate the other discretizations by offsetting the last joint from the solution of the base discretization.
+    // Offset solutions that exceed the joint limits or are invalid (e.g., in collision) fall back to full IK, except
+    // for the discretizations before the base discretization, for which full IK has already failed
+    const moveit::core::VariableBounds& wrist_bounds = jmg_->getActiveJointModels().back()->getVariableBounds().front();
+    const std::size_t n_others = base < solutions.size() ? solutions.size() - 1 : 0;
+    utils::parallelFor(n_others, n_threads_, [&](std::size_t offset) {
+      if (done())
+        return false;
+
+      const std::size_t i = offset < base ? offset : offset + 1;
+      Context& ctx = getContext();
+
+      std::vector<double> solution = solutions[base];
+      solution.back() += wrist_axis_sign_ * (double(i) - double(base)) * dt_;
+      if (wrapIntoBounds(solution.back(), wrist_bounds) && isIKSolutionValid(ctx, &ctx.state, jmg_, solution.data()))
+      {
+        solutions[i] = std::move(solution);
+        ++n_solutions;
+      }
+      else if (i > base)
+      {
+        solve(ctx, i, seed_subset);
+      }
+
+      return true;
+    });
+  }
+  else if (adaptive_)
+  {
+    const std::size_t n = solutions.size();
+    const std::size_t stride = clamp<std::size_t>(std::size_t(std::round(coarse_dt_ / dt_)), 1, n);
+
+    // Start with the coarse samples, each solved from the original seed
+    std::vector<std::pair<std::size_t, const std::vector<double>*>> batch;
+    for (std::size_t i = 0; i < n; i += stride)
+      batch.emplace_back(i, &seed_subset);
+
+    std::vector<char> evaluated(n, false);
+    while (!batch.empty() && !done())
+    {
+      utils::parallelFor(batch.size(), n_threads_, [&](std::size_t j) {
+        solve(getContext(), batch[j].first, *batch[j].second);
+        return !done();
+      });
+
+      for (const auto& sample : batch)
+        evaluated[sample.first] = true;
+
+      std::vector<std::size_t> samples;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (evaluated[i])
+          samples.push_back(i);
+      }
+
+      // Bisect the intervals (wrapping around the circle) between adjacent samples whose feasibility differs
+      batch.clear();
+      for (std::size_t k = 0; k < samples.size(); ++k)
+      {
+        const std::size_t a = samples[k];
+        const std::size_t b = samples[(k + 1) % samples.size()];
+        const std::size_t gap = (b + n - a) % n;
+        const bool a_feasible = !solutions[a].empty();
+        if (gap < 2 || a_feasible == !solutions[b].empty())
+          continue;
+
+        batch.emplace_back((a + gap / 2) % n, a_feasible ? &solutions[a] : &solutions[b]);
+      }
+    }
+  }
+  else if (continuation_)
+  {
+    // Sweep one contiguous range of angles per thread
+    const std::size_t n_ranges = std::min<std::size_t>(n_threads_, n_discretizations_);
+    utils::parallelFor(n_ranges, n_threads_, [&](std::size_t range) {
+      Context& ctx = getContext();
+      const std::size_t begin = range * n_discretizations_ / n_ranges;
+      const std::size_t end = (range + 1) * n_discretizations_ / n_ranges;
+
+      const std::vector<double>* discretization_seed = &seed_subset;
+      for (std::size_t i = begin; i < end && !done(); ++i)
+      {
+        // Seed the next discretization with this solution, or fall back to the original seed after a failure
+        discretization_seed = solve(ctx, i, *discretization_seed) ? &solutions[i] : &seed_subset;
+      }
 
-    if (!tmp_sols.empty())
-      solutions.push_back(tmp_sols.front());
+      return !done();
+    });
   }
+  else
+  {
+    // The discretizations are independent, so solve them in parallel
+    utils::parallelFor(n_discretizations_, n_threads_, [&](std::size_t i) {
+      solve(getContext(), i, seed_subset);
+      return !done();
+    });
+  }
+
+  solutions.erase(std::remove_if(solutions.begin(), solutions.end(),
+                                 [](const std::vector<double>& solution) { return solution.empty(); }),
+                  solutions.end());
 
   return solutions;
 }
 
+void DiscretizedMoveItIKSolver::setNumThreads(std::size_t n_threads)
+{
+  n_threads_ = std::max<std::size_t>(n_threads, 1);
+}
+
+void DiscretizedMoveItIKSolver::setMaxDiscretizedSolutions(std::size_t max_solutions)
+{
+  max_discretized_solutions_ = max_solutions;
+}
+
+void DiscretizedMoveItIKSolver::setContinuation(bool continuation)
+{
+  continuation_ = continuation;
+}
+
+void DiscretizedMoveItIKSolver::setWristAxisShortcut(bool wrist_axis_shortcut)
+{
+  wrist_axis_shortcut_ = wrist_axis_shortcut;
+}
+
+void DiscretizedMoveItIKSolver::setAdaptive(bool adaptive, double coarse_dt)
+{
+  adaptive_ = adaptive;
+  coarse_dt_ = std::abs(coarse_dt);
+}
+
 reach::IKSolver::ConstPtr DiscretizedMoveItIKSolverFactory::create(const YAML::Node& config) const
 {
   auto planning_group = reach::get<std::string>(config, "planning_group");
@@ -200,26 +1201,59 @@ reach::IKSolver::ConstPtr DiscretizedMoveItIKSolverFactory::create(const YAML::N
   }
   dt = clamped_dt;
 
-  auto ik_solver = std::make_shared<DiscretizedMoveItIKSolver>(model, planning_group, dist_threshold, dt);
-
-  // Optionally add a collision mesh
-  const std::string collision_mesh_filename_key = "collision_mesh_filename";
-  const std::string collision_mesh_frame_key = "collision_mesh_key";
-  if (config[collision_mesh_filename_key])
+  // Each discretization is solved once from the input seed, so the multi-seed and multi-solution parameters of the
+  // base solver do not apply; reject them rather than silently ignoring them
+  for (const std::string key : { "max_solutions", "solution_tolerance", "seed_states", "n_random_seeds", "seed_threads",
+                                 "seed_cache_resolution", "seed_cache_neighbors" })
   {
-    auto collision_mesh_filename = reach::get<std::string>(config, collision_mesh_filename_key);
-    std::string collision_mesh_frame = config[collision_mesh_frame_key] ?
-                                           reach::get<std::string>(config, collision_mesh_frame_key) :
-                                           ik_solver->getKinematicBaseFrame();
+    if (config[key])
+      throw std::runtime_error("Parameter '" + key + "' is not supported by the discretized MoveIt IK solver");
+  }
 
-    ik_solver->addCollisionMesh(collision_mesh_filename, collision_mesh_frame);
+  // The wrist-axis shortcut, adaptive discretization, and continuation seeding are alternative ways of solving the
+  // discretizations, so at most one of them can be enabled
+  const std::string continuation_key = "discretization_continuation";
+  const std::string wrist_axis_shortcut_key = "wrist_axis_shortcut";
+  const std::string adaptive_key = "adaptive_discretization";
+  const std::string coarse_dt_key = "coarse_discretization_angle";
+  std::vector<std::string> enabled_keys;
+  for (const std::string& key : { wrist_axis_shortcut_key, adaptive_key, continuation_key })
+  {
+    if (config[key] && reach::get<bool>(config, key))
+      enabled_keys.push_back(key);
   }
+  if (enabled_keys.size() > 1)
+    throw std::runtime_error("Parameters '" + enabled_keys[0] + "' and '" + enabled_keys[1] +
+                             "' cannot be enabled together");
+  if (config[coarse_dt_key] && !(config[adaptive_key] && reach::get<bool>(config, adaptive_key)))
+    throw std::runtime_error("Parameter '" + coarse_dt_key + "' requires '" + adaptive_key + "' to be enabled");
 
-  const std::string touch_links_key = "touch_links";
-  if (config[touch_links_key])
+  auto ik_solver = std::make_shared<DiscretizedMoveItIKSolver>(model, planning_group, dist_threshold, dt);
+  configure(*ik_solver, config);
+
+  // Optionally solve the discretizations in parallel
+  const std::string n_threads_key = "discretization_threads";
+  if (config[n_threads_key])
+    ik_solver->setNumThreads(reach::get<std::size_t>(config, n_threads_key));
+
+  // Optionally stop after a number of feasible discretizations have been found
+  const std::string max_solutions_key = "max_discretized_solutions";
+  if (config[max_solutions_key])
+    ik_solver->setMaxDiscretizedSolutions(reach::get<std::size_t>(config, max_solutions_key));
+
+  // Optionally seed each discretization with the solution of the previous one
+  if (config[continuation_key])
+    ik_solver->setContinuation(reach::get<bool>(config, continuation_key));
+
+  // Optionally enable the wrist-axis shortcut
+  if (config[wrist_axis_shortcut_key])
+    ik_solver->setWristAxisShortcut(reach::get<bool>(config, wrist_axis_shortcut_key));
+
+  // Optionally sample the discretizations coarse-to-fine
+  if (config[adaptive_key])
   {
-    auto touch_links = reach::get<std::vector<std::string>>(config, touch_links_key);
-    ik_solver->setTouchLinks(touch_links);
+    double coarse_dt = config[coarse_dt_key] ? reach::get<double>(config, coarse_dt_key) : M_PI / 4.0;
+    ik_solver->setAdaptive(reach::get<bool>(config, adaptive_key), coarse_dt);
   }
 
   return ik_solver;
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/seed_cache.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace reach_ros
+{
+namespace ik
+{
+std::size_t SeedCache::KeyHash::operator()(const Key& key) const
+{
+  // Combine the voxel indices with large primes, as is common for spatial hashing
+  return static_cast<std::size_t>(key[0] * 73856093L ^ key[1] * 19349663L ^ key[2] * 83492791L);
+}
+
+SeedCache::SeedCache(double resolution, std::size_t max_entries_per_voxel)
+  : resolution_(resolution), max_entries_per_voxel_(std::max<std::size_t>(max_entries_per_voxel, 1))
+{
+  if (resolution_ <= 0.0)
+    throw std::runtime_error("Seed cache resolution must be positive");
+}
+
+std::vector<std::vector<double>> SeedCache::getSeeds(const Eigen::Isometry3d& target, std::size_t n) const
+{
+  const Eigen::Vector3d position = target.translation();
+  const Eigen::Matrix3d orientation = target.linear();
+  const Key key = getKey(position);
+
+  std::vector<std::pair<double, std::vector<double>>> candidates;
+  for (long dx = -1; dx <= 1; ++dx)
+  {
+    for (long dy = -1; dy <= 1; ++dy)
+    {
+      for (long dz = -1; dz <= 1; ++dz)
+      {
+        const Key neighbor{ key[0] + dx, key[1] + dy, key[2] + dz };
+        const Shard& shard = getShard(neighbor);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.voxels.find(neighbor);
+        if (it == shard.voxels.end())
+          continue;
+
+        for (const Entry& entry : it->second)
+        {
+          const double angle = Eigen::AngleAxisd(orientation.transpose() * entry.orientation).angle();
+          const double distance = (entry.position - position).norm() + resolution_ * angle;
+          candidates.emplace_back(distance, entry.solution);
+        }
+      }
+    }
+  }
+
+  n = std::min(n, candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + n, candidates.end(),
+                    [](const std::pair<double, std::vector<double>>& lhs,
+                       const std::pair<double, std::vector<double>>& rhs) { return lhs.first < rhs.first; });
+
+  std::vector<std::vector<double>> seeds;
+  seeds.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    seeds.push_back(std::move(candidates[i].second));
+
+  return seeds;
+}
+
+void SeedCache::insert(const Eigen::Isometry3d& target, const std::vector<double>& solution)
+{
+  const Key key = getKey(target.translation());
+  Shard& shard = getShard(key);
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  std::deque<Entry>& entries = shard.voxels[key];
+  entries.push_back(Entry{ target.translation(), target.linear(), solution });
+
+  // Retain only the most recent entries of the voxel
+  if (entries.size() > max_entries_per_voxel_)
+    entries.pop_front();
+}
+
+SeedCache::Key SeedCache::getKey(const Eigen::Vector3d& position) const
+{
+  return Key{ static_cast<long>(std::floor(position.x() / resolution_)),
+              static_cast<long>(std::floor(position.y() / resolution_)),
+              static_cast<long>(std::floor(position.z() / resolution_)) };
+}
+
+SeedCache::Shard& SeedCache::getShard(const Key& key) const
+{
+  return shards_[KeyHash()(key) % shards_.size()];
+}
+
+}  // namespace ik
+}  // namespace reach_ros
@@ -0,0 +1,358 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/wavefront_ik_solver.h>
+#include <reach_ros/utils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <reach/plugin_utils.h>
+#include <ros/console.h>
+#include <thread>
+#include <yaml-cpp/yaml.h>
+
+namespace
+{
+using Voxel = std::array<long, 3>;
+
+struct VoxelHash
+{
+  std::size_t operator()(const Voxel& v) const
+  {
+    return static_cast<std::size_t>(v[0] * 73856093L ^ v[1] * 19349663L ^ v[2] * 83492791L);
+  }
+};
+
+Voxel getVoxel(const Eigen::Vector3d& position, double resolution)
+{
+  return Voxel{ static_cast<long>(std::floor(position.x() / resolution)),
+                static_cast<long>(std::floor(position.y() / resolution)),
+                static_cast<long>(std::floor(position.z() / resolution)) };
+}
+
+}  // namespace
+
+namespace reach_ros
+{
+namespace ik
+{
+std::size_t WavefrontIKSolver::KeyHash::operator()(const Key& key) const
+{
+  std::size_t hash = 0;
+  for (long long value : key)
+    hash ^= std::hash<long long>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+WavefrontIKSolver::WavefrontIKSolver(reach::IKSolver::ConstPtr ik_solver, reach::VectorIsometry3d targets,
+                                     double neighbor_radius, std::size_t n_anchors, std::size_t n_threads)
+  : ik_solver_(std::move(ik_solver))
+  , targets_(std::move(targets))
+  , neighbor_radius_(neighbor_radius)
+  , n_anchors_(std::max<std::size_t>(n_anchors, 1))
+  , n_threads_(std::max<std::size_t>(n_threads, 1))
+  , stop_(false)
+  , solutions_(targets_.size())
+  , resolved_(targets_.size(), false)
+  , served_(targets_.size(), false)
+{
+  if (!ik_solver_)
+    throw std::runtime_error("Wavefront IK solver requires an IK solver to wrap");
+  if (neighbor_radius_ <= 0.0)
+    throw std::runtime_error("Wavefront IK solver neighbor radius must be positive");
+
+  for (std::size_t i = 0; i < targets_.size(); ++i)
+    index_.emplace(getKey(targets_[i]), i);
+}
+
+WavefrontIKSolver::~WavefrontIKSolver()
+{
+  stop_ = true;
+  if (propagation_.joinable())
+    propagation_.join();
+}
+
+std::vector<std::vector<double>> WavefrontIKSolver::solveIK(const Eigen::Isometry3d& target,
+                                                            const std::map<std::string, double>& seed) const
+{
+  // The first request starts the propagation from its seed
+  std::call_once(started_, [this, &seed]() {
+    propagation_ = std::thread([this, seed]() {
+      try
+      {
+        propagate(seed);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = std::current_exception();
+        resolved_cv_.notify_all();
+      }
+    });
+  });
+
+  auto it = index_.find(getKey(target));
+  if (it != index_.end())
+  {
+    // Wait for the frontier of the target rather than for the whole propagation
+    const std::size_t i = it->second;
+    std::unique_lock<std::mutex> lock(mutex_);
+    resolved_cv_.wait(lock, [this, i]() { return resolved_[i] || error_; });
+    if (error_)
+      std::rethrow_exception(error_);
+
+    if (!served_[i])
+    {
+      served_[i] = true;
+      return solutions_[i];
+    }
+  }
+
+  // Solve targets that are not in the target set, or that have been requested before, with the wrapped solver and the
+  // input seed
+  return ik_solver_->solveIK(target, seed);
+}
+
+std::vector<std::string> WavefrontIKSolver::getJointNames() const
+{
+  return ik_solver_->getJointNames();
+}
+
+std::uint64_t WavefrontIKSolver::getKinematicsHash() const
+{
+  return ik::getKinematicsHash(*ik_solver_);
+}
+
+void WavefrontIKSolver::propagate(const std::map<std::string, double>& seed) const
+{
+  const std::size_t n = targets_.size();
+  const std::size_t unvisited = std::numeric_limits<std::size_t>::max();
+  const std::vector<std::vector<std::size_t>> neighbors = getNeighbors();
+  const std::vector<std::string> joint_names = ik_solver_->getJointNames();
+
+  std::vector<std::size_t> depths(n, unvisited);
+
+  // Solve a target from the solution of its nearest neighbor in an earlier frontier, or from the input seed if none of
+  // those neighbors were solved. Only earlier frontiers are considered, since targets of the current frontier are being
+  // solved concurrently
+  auto solve = [&](std::size_t i) {
+    if (stop_)
+      return;
+
+    const std::vector<double>* nearest = nullptr;
+    double nearest_distance = std::numeric_limits<double>::max();
+    for (std::size_t j : neighbors[i])
+    {
+      if (depths[j] >= depths[i] || solutions_[j].empty())
+        continue;
+
+      const double distance = (targets_[j].translation() - targets_[i].translation()).norm();
+      if (distance < nearest_distance)
+      {
+        nearest_distance = distance;
+        nearest = &solutions_[j].front();
+      }
+    }
+
+    if (!nearest)
+    {
+      solutions_[i] = ik_solver_->solveIK(targets_[i], seed);
+      return;
+    }
+
+    std::map<std::string, double> neighbor_seed;
+    for (std::size_t k = 0; k < joint_names.size(); ++k)
+      neighbor_seed[joint_names[k]] = (*nearest)[k];
+
+    solutions_[i] = ik_solver_->solveIK(targets_[i], neighbor_seed);
+
+    // The solution of a neighbor is usually the better seed, but not always
+    if (solutions_[i].empty())
+      solutions_[i] = ik_solver_->solveIK(targets_[i], seed);
+  };
+
+  std::vector<std::size_t> frontier = getAnchors();
+  for (std::size_t i : frontier)
+    depths[i] = 0;
+
+  std::size_t depth = 0;
+  std::size_t n_waves = 1;
+  std::size_t next_unvisited = 0;
+  while (true)
+  {
+    if (frontier.empty())
+    {
+      // Start a new wave from an unvisited target, which is disconnected from all visited targets
+      while (next_unvisited < n && depths[next_unvisited] != unvisited)
+        ++next_unvisited;
+
+      if (next_unvisited == n)
+        break;
+
+      depths[next_unvisited] = depth;
+      frontier.push_back(next_unvisited);
+      ++n_waves;
+    }
+
+    utils::parallelFor(frontier.size(), n_threads_, [&](std::size_t k) {
+      solve(frontier[k]);
+      return !stop_;
+    });
+
+    if (stop_)
+      return;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (std::size_t i : frontier)
+        resolved_[i] = true;
+    }
+    resolved_cv_.notify_all();
+
+    // Expand to the unvisited neighbors of the frontier, including those of targets that failed to solve
+    std::vector<std::size_t> next_frontier;
+    for (std::size_t i : frontier)
+    {
+      for (std::size_t j : neighbors[i])
+      {
+        if (depths[j] == unvisited)
+        {
+          depths[j] = depth + 1;
+          next_frontier.push_back(j);
+        }
+      }
+    }
+
+    frontier = std::move(next_frontier);
+    ++depth;
+  }
+
+  const std::size_t n_solved = static_cast<std::size_t>(
+      std::count_if(solutions_.begin(), solutions_.end(), [](const std::vector<std::vector<double>>& s) {
+        return !s.empty();
+      }));
+  ROS_INFO_STREAM("Wavefront IK: solved " << n_solved << " of " << n << " targets in " << depth << " frontiers ("
+                                          << n_waves << " waves)");
+}
+
+std::vector<std::vector<std::size_t>> WavefrontIKSolver::getNeighbors() const
+{
+  // Hash the targets into voxels with the size of the neighbor radius, such that all neighbors of a target lie in its
+  // voxel or an adjacent voxel
+  std::unordered_map<Voxel, std::vector<std::size_t>, VoxelHash> voxels;
+  for (std::size_t i = 0; i < targets_.size(); ++i)
+    voxels[getVoxel(targets_[i].translation(), neighbor_radius_)].push_back(i);
+
+  std::vector<std::vector<std::size_t>> neighbors(targets_.size());
+  for (std::size_t i = 0; i < targets_.size(); ++i)
+  {
+    const Voxel voxel = getVoxel(targets_[i].translation(), neighbor_radius_);
+    for (long dx = -1; dx <= 1; ++dx)
+    {
+      for (long dy = -1; dy <= 1; ++dy)
+      {
+        for (long dz = -1; dz <= 1; ++dz)
+        {
+          auto it = voxels.find(Voxel{ voxel[0] + dx, voxel[1] + dy, voxel[2] + dz });
+          if (it == voxels.end())
+            continue;
+
+          for (std::size_t j : it->second)
+          {
+            if (j != i && (targets_[j].translation() - targets_[i].translation()).norm() <= neighbor_radius_)
+              neighbors[i].push_back(j);
+          }
+        }
+      }
+    }
+  }
+
+  return neighbors;
+}
+
+std::vector<std::size_t> WavefrontIKSolver::getAnchors() const
+{
+  std::vector<std::size_t> anchors;
+  if (targets_.empty())
+    return anchors;
+
+  Eigen::Vector3d centroid = Eigen::Vector3d::Zero();
+  for (const Eigen::Isometry3d& target : targets_)
+    centroid += target.translation();
+  centroid /= double(targets_.size());
+
+  // The distance from each target to its nearest anchor, initially the distance to the centroid
+  std::vector<double> distances(targets_.size());
+  for (std::size_t i = 0; i < targets_.size(); ++i)
+    distances[i] = (targets_[i].translation() - centroid).norm();
+
+  // Start with the target nearest the centroid, then repeatedly add the target farthest from all anchors
+  std::size_t next = std::distance(distances.begin(), std::min_element(distances.begin(), distances.end()));
+  std::fill(distances.begin(), distances.end(), std::numeric_limits<double>::max());
+  while (anchors.size() < std::min(n_anchors_, targets_.size()))
+  {
+    anchors.push_back(next);
+    for (std::size_t i = 0; i < targets_.size(); ++i)
+      distances[i] = std::min(distances[i], (targets_[i].translation() - targets_[next].translation()).norm());
+
+    next = std::distance(distances.begin(), std::max_element(distances.begin(), distances.end()));
+  }
+
+  return anchors;
+}
+
+WavefrontIKSolver::Key WavefrontIKSolver::getKey(const Eigen::Isometry3d& target)
+{
+  // The targets requested by the reach study are the generated poses themselves, so a fine quantization suffices to
+  // absorb round-off
+  const double tolerance = 1.0e-6;
+
+  Eigen::Quaterniond q(target.linear());
+  if (q.w() < 0.0)
+    q.coeffs() *= -1.0;
+
+  Key key;
+  for (Eigen::Index i = 0; i < 3; ++i)
+    key[i] = std::llround(target.translation()[i] / tolerance);
+  for (Eigen::Index i = 0; i < 4; ++i)
+    key[3 + i] = std::llround(q.coeffs()[i] / tolerance);
+
+  return key;
+}
+
+reach::IKSolver::ConstPtr WavefrontIKSolverFactory::create(const YAML::Node& config) const
+{
+  reach::IKSolver::ConstPtr ik_solver = utils::loadIKSolver(config["ik_solver"]);
+  reach::TargetPoseGenerator::ConstPtr target_pose_generator =
+      utils::loadTargetPoseGenerator(config["target_pose_generator"]);
+
+  auto neighbor_radius = reach::get<double>(config, "neighbor_radius");
+
+  const std::string n_anchors_key = "n_anchors";
+  std::size_t n_anchors = config[n_anchors_key] ? reach::get<std::size_t>(config, n_anchors_key) : 1;
+
+  const std::string n_threads_key = "wavefront_threads";
+  std::size_t n_threads =
+      config[n_threads_key] ? reach::get<std::size_t>(config, n_threads_key) : std::thread::hardware_concurrency();
+
+  return std::make_shared<WavefrontIKSolver>(ik_solver, target_pose_generator->generate(), neighbor_radius, n_anchors,
+                                             n_threads);
+}
+
+}  // namespace ik
+}  // namespace reach_ros
+
+EXPORT_IK_SOLVER_PLUGIN(reach_ros::ik::WavefrontIKSolverFactory, WavefrontIKSolver)
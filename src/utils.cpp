@@ -14,17 +14,107 @@
  * limitations under the License.
  */
 #include <reach_ros/utils.h>
-
+#include <reach_ros/collision/self_collision_sampling.h>
+#include <reach_ros/collision/signed_distance_field.h>
+
+#include <algorithm>
+#include <atomic>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <boost_plugin_loader/plugin_loader.hpp>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <geometric_shapes/mesh_operations.h>
 #include <geometric_shapes/shape_operations.h>
 #include <geometric_shapes/shapes.h>
+#include <iomanip>
+#include <map>
+#include <moveit/collision_detection/collision_env.h>
+#include <moveit/collision_detection/world.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/robot_state.h>
+#include <reach/interfaces/ik_solver.h>
+#include <reach/interfaces/target_pose_generator.h>
+#include <reach/plugin_utils.h>
 #include <reach/types.h>
+#include <resource_retriever/retriever.h>
 #include <ros/ros.h>
 #include <eigen_conversions/eigen_msg.h>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <yaml-cpp/yaml.h>
 
 const static double ARROW_SCALE_RATIO = 6.0;
 const static double NEIGHBOR_MARKER_SCALE_RATIO = ARROW_SCALE_RATIO / 2.0;
 
+namespace
+{
+const std::string CACHE_DIR_ENV = "REACH_ROS_CACHE_DIR";
+const char MESH_CACHE_MAGIC[8] = { 'R', 'R', 'M', 'E', 'S', 'H', '1', '\0' };
+
+/** @brief Number of recent distance queries memoized by each thread */
+const std::size_t DISTANCE_MEMO_SIZE = 8;
+
+/** @brief Distance query memoized by memoizeDistance */
+struct MemoizedDistance
+{
+  std::uint64_t query_key;
+  std::vector<double> positions;
+  double max_distance;
+  double distance;
+};
+
+/** @brief Returns the pose of a frame in the default state of a robot model, as a planning scene places objects */
+Eigen::Isometry3d getDefaultFrameTransform(const moveit::core::RobotModelConstPtr& model, const std::string& frame)
+{
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+  state.update();
+  if (!state.knowsFrameTransform(frame))
+    throw std::runtime_error("Unknown collision mesh frame '" + frame + "'");
+
+  return state.getFrameTransform(frame);
+}
+
+/**
+ * @brief Loads a reach plugin factory by the name in the input configuration and creates the plugin from that
+ * configuration
+ * @details The returned plugin shares ownership of its factory, such that the plugin library stays loaded for the
+ * lifetime of the plugin
+ */
+template <typename FactoryT>
+auto loadPlugin(const YAML::Node& config) -> decltype(std::declval<FactoryT>().create(config))
+{
+  using PluginPtr = decltype(std::declval<FactoryT>().create(config));
+
+  boost_plugin_loader::PluginLoader loader;
+  loader.search_libraries.insert("reach_plugins");
+  loader.search_libraries.insert("reach_ros_plugins");
+  loader.search_libraries_env = "REACH_PLUGINS";
+
+  // Members are destroyed in reverse order, so the factory outlives the plugin
+  struct Holder
+  {
+    std::shared_ptr<FactoryT> factory;
+    PluginPtr plugin;
+  };
+
+  auto holder = std::make_shared<Holder>();
+  holder->factory = loader.createInstance<FactoryT>(reach::get<std::string>(config, "name"));
+  holder->plugin = holder->factory->create(config);
+
+  return PluginPtr(holder, holder->plugin.get());
+}
+
+}  // namespace
+
 namespace reach_ros
 {
 namespace utils
@@ -37,8 +127,7 @@ moveit_msgs::CollisionObject createCollisionObject(const std::string& mesh_filen
   obj.header.frame_id = parent_link;
   obj.id = object_name;
   shapes::ShapeMsg shape_msg;
-  shapes::Mesh* mesh = shapes::createMeshFromResource(mesh_filename);
-  shapes::constructMsgFromShape(mesh, shape_msg);
+  shapes::constructMsgFromShape(loadMesh(mesh_filename).get(), shape_msg);
   obj.meshes.push_back(boost::get<shape_msgs::Mesh>(shape_msg));
   obj.operation = obj.ADD;
 
@@ -52,6 +141,420 @@ moveit_msgs::CollisionObject createCollisionObject(const std::string& mesh_filen
   return obj;
 }
 
+std::shared_ptr<const shapes::Mesh> readCachedMesh(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  if (!file)
+    return nullptr;
+  const std::streamoff file_size = file.tellg();
+  file.seekg(0);
+
+  char magic[sizeof(MESH_CACHE_MAGIC)];
+  std::uint32_t vertex_count = 0;
+  std::uint32_t triangle_count = 0;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char*>(&vertex_count), sizeof(vertex_count));
+  file.read(reinterpret_cast<char*>(&triangle_count), sizeof(triangle_count));
+  if (!file || std::memcmp(magic, MESH_CACHE_MAGIC, sizeof(magic)) != 0)
+    return nullptr;
+
+  // Check the counts against the size of the file before allocating the mesh, such that a truncated or corrupt file
+  // is discarded rather than read into a mesh of the wrong size
+  const std::uint64_t vertex_bytes = 3 * sizeof(double) * std::uint64_t(vertex_count);
+  const std::uint64_t triangle_bytes = 3 * sizeof(unsigned int) * std::uint64_t(triangle_count);
+  if (std::uint64_t(file_size - file.tellg()) != vertex_bytes + triangle_bytes)
+    return nullptr;
+
+  auto mesh = std::make_shared<shapes::Mesh>(vertex_count, triangle_count);
+  file.read(reinterpret_cast<char*>(mesh->vertices), std::streamsize(vertex_bytes));
+  file.read(reinterpret_cast<char*>(mesh->triangles), std::streamsize(triangle_bytes));
+  if (!file)
+    return nullptr;
+
+  if (std::any_of(mesh->triangles, mesh->triangles + 3 * triangle_count,
+                  [vertex_count](unsigned int vertex) { return vertex >= vertex_count; }))
+    return nullptr;
+
+  // Normals are cheap to compute relative to parsing, so they are not stored
+  mesh->computeTriangleNormals();
+  mesh->computeVertexNormals();
+  return mesh;
+}
+
+void writeCachedMesh(std::ostream& stream, const shapes::Mesh& mesh)
+{
+  const std::uint32_t vertex_count = mesh.vertex_count;
+  const std::uint32_t triangle_count = mesh.triangle_count;
+  stream.write(MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+  stream.write(reinterpret_cast<const char*>(&vertex_count), sizeof(vertex_count));
+  stream.write(reinterpret_cast<const char*>(&triangle_count), sizeof(triangle_count));
+  stream.write(reinterpret_cast<const char*>(mesh.vertices), std::streamsize(3 * sizeof(double) * vertex_count));
+  stream.write(reinterpret_cast<const char*>(mesh.triangles),
+               std::streamsize(3 * sizeof(unsigned int) * triangle_count));
+}
+
+std::shared_ptr<const shapes::Mesh> loadMesh(const std::string& mesh_filename)
+{
+  // Meshes are held weakly, such that they are released once no plugin uses them
+  static std::mutex mutex;
+  static std::map<std::string, std::weak_ptr<const shapes::Mesh>> meshes;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::weak_ptr<const shapes::Mesh>& entry = meshes[mesh_filename];
+  if (std::shared_ptr<const shapes::Mesh> mesh = entry.lock())
+    return mesh;
+
+  std::shared_ptr<const shapes::Mesh> mesh;
+  if (!std::getenv(CACHE_DIR_ENV.c_str()))
+  {
+    mesh.reset(shapes::createMeshFromResource(mesh_filename));
+  }
+  else
+  {
+    resource_retriever::MemoryResource resource;
+    try
+    {
+      resource = resource_retriever::Retriever().get(mesh_filename);
+    }
+    catch (const resource_retriever::Exception& ex)
+    {
+      throw std::runtime_error("Failed to retrieve mesh '" + mesh_filename + "': " + ex.what());
+    }
+
+    // Key the cache on the file contents, such that modified files are never served stale meshes
+    const std::string cache_file = getCacheFilename(hashBytes(resource.data.get(), resource.size), ".mesh");
+    mesh = readCachedMesh(cache_file);
+    if (!mesh)
+    {
+      // The file extension of the resource tells the mesh importer its format
+      mesh.reset(shapes::createMeshFromBinary(reinterpret_cast<const char*>(resource.data.get()), resource.size,
+                                              mesh_filename));
+      if (mesh)
+        writeCacheFile(cache_file, [&mesh](std::ostream& stream) { writeCachedMesh(stream, *mesh); });
+    }
+  }
+
+  if (!mesh)
+    throw std::runtime_error("Failed to load mesh '" + mesh_filename + "'");
+
+  entry = mesh;
+  return mesh;
+}
+
+collision_detection::WorldPtr getCollisionWorld(const moveit::core::RobotModelConstPtr& model,
+                                                const std::string& mesh_filename, const std::string& frame,
+                                                const std::string& object_name,
+                                                const collision::MeshDecimation& decimation, double* decimation_error)
+{
+  using Key = std::tuple<std::string, std::string, std::string, std::string, std::size_t, double>;
+  struct Entry
+  {
+    std::weak_ptr<collision_detection::World> world;
+    double decimation_error = 0.0;
+  };
+  static std::mutex mutex;
+  static std::map<Key, Entry> worlds;
+
+  std::string parent_frame = frame;
+  if (!parent_frame.empty() && parent_frame.front() == '/')
+    parent_frame.erase(0, 1);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  Entry& entry = worlds[Key(model->getName(), mesh_filename, parent_frame, object_name, decimation.max_triangles,
+                            decimation.tolerance)];
+  if (collision_detection::WorldPtr world = entry.world.lock())
+  {
+    if (decimation_error)
+      *decimation_error = entry.decimation_error;
+    return world;
+  }
+
+  const Eigen::Isometry3d pose = getDefaultFrameTransform(model, parent_frame);
+  std::shared_ptr<const shapes::Mesh> mesh = loadMesh(mesh_filename);
+  double error = 0.0;
+  if (decimation.enabled())
+  {
+    std::shared_ptr<const shapes::Mesh> decimated_mesh = collision::decimateMesh(*mesh, decimation, error);
+    ROS_INFO_STREAM("Decimated collision mesh '" << mesh_filename << "' from " << mesh->triangle_count << " to "
+                                                 << decimated_mesh->triangle_count << " triangles (maximum deviation "
+                                                 << "of " << error << " m, by which the robot links are padded)");
+    mesh = std::move(decimated_mesh);
+  }
+
+  auto world = std::make_shared<collision_detection::World>();
+  world->addToObject(object_name, mesh, pose);
+  entry.world = world;
+  entry.decimation_error = error;
+
+  if (decimation_error)
+    *decimation_error = error;
+  return world;
+}
+
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t hash)
+{
+  const auto* bytes = static_cast<const std::uint8_t*>(data);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string getCacheFilename(std::uint64_t key, const std::string& extension)
+{
+  const char* cache_dir = std::getenv(CACHE_DIR_ENV.c_str());
+  if (!cache_dir)
+    return "";
+
+  std::stringstream ss;
+  ss << std::hex << std::setfill('0') << std::setw(16) << key << extension;
+  return (boost::filesystem::path(cache_dir) / ss.str()).string();
+}
+
+void writeCacheFile(const std::string& filename, const std::function<void(std::ostream&)>& write)
+{
+  try
+  {
+    const boost::filesystem::path path(filename);
+    boost::filesystem::create_directories(path.parent_path());
+    const boost::filesystem::path tmp_path = filename + boost::filesystem::unique_path(".%%%%%%%%").string();
+    {
+      std::ofstream file(tmp_path.string(), std::ios::binary);
+      write(file);
+      if (!file)
+        throw std::runtime_error("Failed to write '" + tmp_path.string() + "'");
+    }
+    boost::filesystem::rename(tmp_path, path);
+  }
+  catch (const std::exception& ex)
+  {
+    ROS_WARN_STREAM("Failed to write cache file '" << filename << "': " << ex.what());
+  }
+}
+
+std::shared_ptr<const collision::SignedDistanceField>
+getSignedDistanceField(const moveit::core::RobotModelConstPtr& model, const std::string& mesh_filename,
+                       const std::string& frame, double resolution, double max_distance,
+                       const collision::MeshDecimation& decimation)
+{
+  using Key = std::tuple<std::string, std::string, std::string, double, double, std::size_t, double>;
+  static std::mutex mutex;
+  static std::map<Key, std::weak_ptr<const collision::SignedDistanceField>> fields;
+
+  std::string parent_frame = frame;
+  if (!parent_frame.empty() && parent_frame.front() == '/')
+    parent_frame.erase(0, 1);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::weak_ptr<const collision::SignedDistanceField>& entry =
+      fields[Key(model->getName(), mesh_filename, parent_frame, resolution, max_distance, decimation.max_triangles,
+                 decimation.tolerance)];
+  if (std::shared_ptr<const collision::SignedDistanceField> sdf = entry.lock())
+    return sdf;
+
+  const Eigen::Isometry3d pose = getDefaultFrameTransform(model, parent_frame);
+  std::shared_ptr<const shapes::Mesh> mesh = loadMesh(mesh_filename);
+  if (decimation.enabled())
+  {
+    double error;
+    mesh = collision::decimateMesh(*mesh, decimation, error);
+  }
+
+  // Key the cache on everything that determines the field, such that changes to any of them are never served stale
+  // fields
+  std::uint64_t key = hashBytes(mesh->vertices, 3 * sizeof(double) * mesh->vertex_count);
+  key = hashBytes(mesh->triangles, 3 * sizeof(unsigned int) * mesh->triangle_count, key);
+  key = hashBytes(pose.matrix().data(), sizeof(double) * 16, key);
+  key = hashBytes(&resolution, sizeof(resolution), key);
+  key = hashBytes(&max_distance, sizeof(max_distance), key);
+  key = hashBytes(&collision::SignedDistanceField::VERSION, sizeof(collision::SignedDistanceField::VERSION), key);
+  const std::string cache_file = getCacheFilename(key, ".sdf");
+
+  std::shared_ptr<const collision::SignedDistanceField> sdf;
+  if (!cache_file.empty())
+  {
+    std::ifstream file(cache_file, std::ios::binary);
+    if (file)
+      sdf = collision::SignedDistanceField::read(file);
+  }
+
+  if (!sdf)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    auto new_sdf = std::make_shared<const collision::SignedDistanceField>(*mesh, pose, resolution, max_distance);
+    ROS_INFO_STREAM("Computed the signed distance field of collision mesh '"
+                    << mesh_filename << "' at a resolution of " << resolution << " m in "
+                    << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s");
+
+    if (!cache_file.empty())
+      writeCacheFile(cache_file, [&new_sdf](std::ostream& stream) { new_sdf->write(stream); });
+    sdf = std::move(new_sdf);
+  }
+
+  entry = sdf;
+  return sdf;
+}
+
+std::shared_ptr<const collision::SampledCollisions>
+getSampledSelfCollisions(const moveit::core::RobotModelConstPtr& model, const std::string& planning_group,
+                         std::size_t n_samples, std::size_t n_threads)
+{
+  using Key = std::tuple<std::string, std::string, std::size_t>;
+  static std::mutex mutex;
+  static std::map<Key, std::shared_ptr<const collision::SampledCollisions>> results;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<const collision::SampledCollisions>& entry =
+      results[Key(model->getName(), planning_group, n_samples)];
+  if (entry)
+    return entry;
+
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(planning_group);
+  if (!jmg)
+    throw std::runtime_error("Failed to get joint model group '" + planning_group + "'");
+
+  // Key the cache on the robot description, which determines both the geometry and the collisions allowed by the SRDF.
+  // Without a robot description on the parameter server there is nothing to key the cache on
+  std::string urdf, srdf;
+  ros::param::get("robot_description", urdf);
+  ros::param::get("robot_description_semantic", srdf);
+  std::string cache_file;
+  if (!urdf.empty())
+  {
+    std::uint64_t key = hashBytes(urdf.data(), urdf.size());
+    key = hashBytes(srdf.data(), srdf.size(), key);
+    key = hashBytes(planning_group.data(), planning_group.size(), key);
+    const std::uint64_t samples = n_samples;
+    key = hashBytes(&samples, sizeof(samples), key);
+    cache_file = getCacheFilename(key, ".acm");
+  }
+
+  if (!cache_file.empty())
+  {
+    std::ifstream file(cache_file);
+    if (file)
+      entry = collision::SampledCollisions::read(file);
+  }
+
+  if (!entry)
+  {
+    // Sample from the collisions allowed by the SRDF, with which a planning scene initializes its matrix
+    const planning_scene::PlanningScene scene(model);
+    const auto start = std::chrono::steady_clock::now();
+    auto collisions = std::make_shared<const collision::SampledCollisions>(collision::sampleSelfCollisions(
+        model, scene.getAllowedCollisionMatrix(), jmg, n_samples, n_threads));
+    ROS_INFO_STREAM("Sampled " << n_samples << " configurations of planning group '" << planning_group << "' in "
+                               << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                               << " s");
+
+    if (!cache_file.empty())
+      writeCacheFile(cache_file, [&collisions](std::ostream& stream) { collisions->write(stream); });
+    entry = std::move(collisions);
+  }
+
+  ROS_INFO_STREAM("Self-collision sampling allows collision between " << entry->never_colliding.size()
+                                                                      << " link pairs that never collide and "
+                                                                      << entry->always_colliding.size()
+                                                                      << " link pairs that always collide");
+  return entry;
+}
+
+std::set<const moveit::core::LinkModel*> getLinkModels(const moveit::core::RobotModelConstPtr& model,
+                                                       const std::vector<std::string>& link_names)
+{
+  std::set<const moveit::core::LinkModel*> links;
+  for (const std::string& name : link_names)
+  {
+    if (!model->hasLinkModel(name))
+      throw std::runtime_error("Robot model '" + model->getName() + "' has no link '" + name + "'");
+    links.insert(model->getLinkModel(name));
+  }
+
+  return links;
+}
+
+double getDistanceToWorld(const collision_detection::CollisionEnv& env, const moveit::core::RobotState& state,
+                          const collision_detection::AllowedCollisionMatrix& acm,
+                          const std::set<const moveit::core::LinkModel*>& links, double max_distance)
+{
+  // Only link pairs with at least one active component are checked, and the world objects are never active
+  collision_detection::DistanceRequest req;
+  req.acm = &acm;
+  req.active_components_only = links.empty() ? nullptr : &links;
+  req.distance_threshold = max_distance;
+  collision_detection::DistanceResult res;
+  env.distanceRobot(req, res, state);
+
+  // The minimum distance is left at its initial (maximum) value if no pair is within the threshold
+  return std::min(res.minimum_distance.distance, max_distance);
+}
+
+std::uint64_t getDistanceQueryKey(const planning_scene::PlanningScene& scene,
+                                  const std::set<const moveit::core::LinkModel*>& links)
+{
+  const collision_detection::World* world = scene.getWorld().get();
+  std::uint64_t key = hashBytes(&world, sizeof(world));
+
+  std::vector<const moveit::core::LinkModel*> query_links;
+  for (const moveit::core::LinkModel* link : scene.getRobotModel()->getLinkModelsWithCollisionGeometry())
+  {
+    if (links.empty() || links.count(link))
+    {
+      query_links.push_back(link);
+      key = hashBytes(&link, sizeof(link), key);
+    }
+  }
+
+  const collision_detection::AllowedCollisionMatrix& acm = scene.getAllowedCollisionMatrix();
+  for (const std::string& id : scene.getWorld()->getObjectIds())
+  {
+    key = hashBytes(id.data(), id.size(), key);
+    for (const moveit::core::LinkModel* link : query_links)
+    {
+      collision_detection::AllowedCollision::Type type;
+      const int entry = acm.getEntry(id, link->getName(), type) ? static_cast<int>(type) : -1;
+      key = hashBytes(&entry, sizeof(entry), key);
+    }
+  }
+
+  return key;
+}
+
+double memoizeDistance(std::uint64_t query_key, const moveit::core::RobotState& state, double max_distance,
+                       const std::function<double()>& compute)
+{
+  // Each thread keeps its own ring of the most recent queries, so no synchronization is needed
+  thread_local std::vector<MemoizedDistance> memo;
+  thread_local std::size_t next = 0;
+
+  const double* positions = state.getVariablePositions();
+  const std::size_t n = state.getVariableCount();
+  for (const MemoizedDistance& entry : memo)
+  {
+    if (entry.query_key != query_key || entry.positions.size() != n ||
+        !std::equal(positions, positions + n, entry.positions.begin()))
+      continue;
+
+    // A distance below the bound of its query is exact; otherwise it is only known to be at least that bound
+    if (entry.distance < entry.max_distance)
+      return std::min(entry.distance, max_distance);
+    if (entry.max_distance >= max_distance)
+      return max_distance;
+  }
+
+  const double distance = compute();
+  MemoizedDistance entry{ query_key, std::vector<double>(positions, positions + n), max_distance, distance };
+  if (memo.size() < DISTANCE_MEMO_SIZE)
+    memo.push_back(std::move(entry));
+  else
+    memo[next] = std::move(entry);
+  next = (next + 1) % DISTANCE_MEMO_SIZE;
+
+  return distance;
+}
+
 visualization_msgs::Marker makeVisual(const reach::ReachRecord& r, const std::string& frame, const double scale,
                                       const std::string& ns, const Eigen::Vector3f& color)
 {
@@ -195,5 +698,92 @@ void initROS(const std::string& node_name)
   }
 }
 
+void parallelFor(std::size_t n, std::size_t max_threads, const std::function<bool(std::size_t)>& fn)
+{
+  struct State
+  {
+    std::size_t n;
+    const std::function<bool(std::size_t)>* fn;
+    std::atomic<std::size_t> next{ 0 };
+    std::atomic<bool> stop{ false };
+    std::exception_ptr error;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t active_helpers = 0;
+    bool done = false;
+
+    void work()
+    {
+      std::size_t i;
+      while (!stop && (i = next++) < n)
+      {
+        try
+        {
+          if (!(*fn)(i))
+            stop = true;
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error)
+            error = std::current_exception();
+          stop = true;
+        }
+      }
+    }
+  };
+
+  auto state = std::make_shared<State>();
+  state->n = n;
+  state->fn = &fn;
+
+  static boost::asio::thread_pool pool(std::max(1u, std::thread::hardware_concurrency()));
+  const std::size_t n_helpers = std::min(n, std::max<std::size_t>(max_threads, 1)) - std::min<std::size_t>(n, 1);
+  for (std::size_t i = 0; i < n_helpers; ++i)
+  {
+    boost::asio::post(pool, [state]() {
+      // Helpers that start after the calling thread has finished have nothing left to do, and must not touch the
+      // function, which may no longer exist
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->done)
+          return;
+        ++state->active_helpers;
+      }
+
+      state->work();
+
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        --state->active_helpers;
+      }
+      state->cv.notify_all();
+    });
+  }
+
+  state->work();
+
+  // Wait only for the helpers that have already started
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done = true;
+    state->cv.wait(lock, [&state]() { return state->active_helpers == 0; });
+  }
+
+  if (state->error)
+    std::rethrow_exception(state->error);
+}
+
+std::shared_ptr<const reach::IKSolver> loadIKSolver(const YAML::Node& config)
+{
+  return loadPlugin<reach::IKSolverFactory>(config);
+}
+
+std::shared_ptr<const reach::TargetPoseGenerator> loadTargetPoseGenerator(const YAML::Node& config)
+{
+  return loadPlugin<reach::TargetPoseGeneratorFactory>(config);
+}
+
 }  // namespace utils
 }  // namespace reach_ros
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/caching_ik_solver.h>
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <yaml-cpp/yaml.h>
+
+using namespace reach_ros;
+
+namespace
+{
+/** @brief IK solver that counts its calls and returns a single solution derived from the target and seed */
+class CountingIKSolver : public reach::IKSolver
+{
+public:
+  std::vector<std::vector<double>> solveIK(const Eigen::Isometry3d& target,
+                                           const std::map<std::string, double>& seed) const override
+  {
+    ++n_calls;
+    return { { target.translation().x(), seed.at("j") } };
+  }
+
+  std::vector<std::string> getJointNames() const override
+  {
+    return { "j" };
+  }
+
+  mutable std::size_t n_calls = 0;
+};
+
+/** @brief Exposes the cache key and shard of a request */
+class TestCachingIKSolver : public ik::CachingIKSolver
+{
+public:
+  using ik::CachingIKSolver::CachingIKSolver;
+  using ik::CachingIKSolver::getMemory;
+
+  std::size_t getShardIndex(const Eigen::Isometry3d& target, const std::map<std::string, double>& seed) const
+  {
+    return KeyHash()(getKey(target, seed)) % shards_.size();
+  }
+
+  std::size_t getNumShards() const
+  {
+    return shards_.size();
+  }
+};
+
+Eigen::Isometry3d createTarget(double x, double angle = 0.0)
+{
+  return Eigen::Translation3d(x, 0.0, 0.0) * Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ());
+}
+
+const std::size_t MAX_MEMORY = 1024 * 1024;
+
+}  // namespace
+
+TEST(CachingIKSolver, RejectsInvalidParameters)
+{
+  auto solver = std::make_shared<CountingIKSolver>();
+  EXPECT_THROW(ik::CachingIKSolver(nullptr, 1.0e-3, 1.0e-3, 1.0e-3, MAX_MEMORY), std::runtime_error);
+  EXPECT_THROW(ik::CachingIKSolver(solver, 0.0, 1.0e-3, 1.0e-3, MAX_MEMORY), std::runtime_error);
+  EXPECT_THROW(ik::CachingIKSolver(solver, 1.0e-3, -1.0e-3, 1.0e-3, MAX_MEMORY), std::runtime_error);
+  EXPECT_THROW(ik::CachingIKSolver(solver, 1.0e-3, 1.0e-3, 0.0, MAX_MEMORY), std::runtime_error);
+}
+
+TEST(CachingIKSolverFactory, RejectsNegativeMemoryLimit)
+{
+  // The parameters are validated before the wrapped IK solver is loaded, so none needs to be configured
+  try
+  {
+    ik::CachingIKSolverFactory().create(YAML::Load("{max_cache_memory: -1}"));
+    FAIL() << "A negative memory limit was accepted";
+  }
+  catch (const std::runtime_error& ex)
+  {
+    EXPECT_NE(std::string(ex.what()).find("max_cache_memory"), std::string::npos) << ex.what();
+  }
+}
+
+TEST(CachingIKSolver, ServesRepeatedRequestsFromCache)
+{
+  auto solver = std::make_shared<CountingIKSolver>();
+  ik::CachingIKSolver cache(solver, 1.0e-3, 1.0e-3, 1.0e-3, MAX_MEMORY);
+
+  const std::vector<std::vector<double>> solutions = cache.solveIK(createTarget(0.5), { { "j", 0.25 } });
+  EXPECT_EQ(solver->n_calls, 1);
+  EXPECT_EQ(cache.solveIK(createTarget(0.5), { { "j", 0.25 } }), solutions);
+  EXPECT_EQ(solver->n_calls, 1);
+  EXPECT_EQ(cache.getJointNames(), solver->getJointNames());
+}
+
+TEST(CachingIKSolver, QuantizesTargetAndSeed)
+{
+  auto solver = std::make_shared<CountingIKSolver>();
+  ik::CachingIKSolver cache(solver, 1.0e-3, 1.0e-3, 1.0e-3, MAX_MEMORY);
+  cache.solveIK(createTarget(0.5), { { "j", 0.25 } });
+
+  // Differences well within the tolerances produce the same key
+  cache.solveIK(createTarget(0.5 + 1.0e-4), { { "j", 0.25 } });
+  cache.solveIK(createTarget(0.5, 1.0e-4), { { "j", 0.25 } });
+  cache.solveIK(createTarget(0.5), { { "j", 0.25 + 1.0e-4 } });
+  EXPECT_EQ(solver->n_calls, 1);
+
+  // Differences of several tolerances produce different keys
+  cache.solveIK(createTarget(0.5 + 5.0e-3), { { "j", 0.25 } });
+  EXPECT_EQ(solver->n_calls, 2);
+  cache.solveIK(createTarget(0.5, 0.1), { { "j", 0.25 } });
+  EXPECT_EQ(solver->n_calls, 3);
+  cache.solveIK(createTarget(0.5), { { "j", 0.3 } });
+  EXPECT_EQ(solver->n_calls, 4);
+}
+
+TEST(CachingIKSolver, EvictsLeastRecentlyUsedEntries)
+{
+  const std::map<std::string, double> seed{ { "j", 0.0 } };
+
+  // Size the cache such that each shard holds exactly two entries
+  auto solver = std::make_shared<CountingIKSolver>();
+  const std::size_t n_shards = TestCachingIKSolver(solver, 1.0e-3, 1.0e-3, 1.0e-3, MAX_MEMORY).getNumShards();
+  const std::size_t entry_memory = TestCachingIKSolver::getMemory(std::vector<long long>(8), { { 0.0, 0.0 } });
+  TestCachingIKSolver cache(solver, 1.0e-3, 1.0e-3, 1.0e-3, n_shards * 2 * entry_memory);
+
+  // Find three targets whose entries share a shard
+  std::vector<Eigen::Isometry3d> targets{ createTarget(0.0) };
+  const std::size_t shard = cache.getShardIndex(targets.front(), seed);
+  for (int i = 1; targets.size() < 3; ++i)
+  {
+    const Eigen::Isometry3d target = createTarget(double(i));
+    if (cache.getShardIndex(target, seed) == shard)
+      targets.push_back(target);
+  }
+
+  cache.solveIK(targets[0], seed);
+  cache.solveIK(targets[1], seed);
+  EXPECT_EQ(solver->n_calls, 2);
+
+  // Use the first entry, such that the second becomes the least recently used and is evicted by the third
+  cache.solveIK(targets[0], seed);
+  cache.solveIK(targets[2], seed);
+  EXPECT_EQ(solver->n_calls, 3);
+
+  cache.solveIK(targets[0], seed);
+  EXPECT_EQ(solver->n_calls, 3);
+  cache.solveIK(targets[1], seed);
+  EXPECT_EQ(solver->n_calls, 4);
+}
+
+TEST(CachingIKSolver, DoesNotCacheEntriesLargerThanShard)
+{
+  auto solver = std::make_shared<CountingIKSolver>();
+  ik::CachingIKSolver cache(solver, 1.0e-3, 1.0e-3, 1.0e-3, 0);
+
+  cache.solveIK(createTarget(0.5), { { "j", 0.25 } });
+  cache.solveIK(createTarget(0.5), { { "j", 0.25 } });
+  EXPECT_EQ(solver->n_calls, 2);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
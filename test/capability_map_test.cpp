@@ -0,0 +1,281 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/caching_ik_solver.h>
+#include <reach_ros/ik/capability_map.h>
+#include <reach_ros/ik/capability_map_ik_solver.h>
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+
+using namespace reach_ros;
+
+namespace
+{
+/** @brief Temporary file that is removed when it goes out of scope */
+struct TemporaryFile
+{
+  TemporaryFile() : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.cmap"))
+  {
+  }
+
+  ~TemporaryFile()
+  {
+    boost::filesystem::remove(path);
+  }
+
+  boost::filesystem::path path;
+};
+
+ik::CapabilityMap::Grid createGrid()
+{
+  ik::CapabilityMap::Grid grid;
+  grid.origin = Eigen::Vector3d(-0.5, -0.5, 0.0);
+  grid.resolution = 0.1;
+  grid.size = { { 10, 10, 5 } };
+  grid.n_direction_divisions = 2;
+  return grid;
+}
+
+/** @brief Returns a pose whose tool Z-axis points along the input direction */
+Eigen::Isometry3d createPose(const Eigen::Vector3d& position, const Eigen::Vector3d& direction)
+{
+  const Eigen::Vector3d z = direction.normalized();
+  const Eigen::Vector3d x = z.unitOrthogonal();
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.linear() << x, z.cross(x), z;
+  pose.translation() = position;
+  return pose;
+}
+
+/** @brief IK solver that never finds a solution */
+class NoSolutionIKSolver : public reach::IKSolver
+{
+public:
+  std::vector<std::vector<double>> solveIK(const Eigen::Isometry3d&,
+                                           const std::map<std::string, double>&) const override
+  {
+    return {};
+  }
+
+  std::vector<std::string> getJointNames() const override
+  {
+    return { "j" };
+  }
+};
+
+const std::uint64_t KINEMATICS_HASH = 0x0123456789abcdefULL;
+
+/** @brief IK solver that never finds a solution, with fixed kinematics */
+class HashedIKSolver : public NoSolutionIKSolver, public ik::KinematicsHashProvider
+{
+public:
+  std::uint64_t getKinematicsHash() const override
+  {
+    return KINEMATICS_HASH;
+  }
+};
+
+}  // namespace
+
+TEST(CapabilityMap, BinsDirectionsOnCubeFaces)
+{
+  const ik::CapabilityMap::Grid grid = createGrid();
+  EXPECT_EQ(grid.getNumBins(), 24);
+
+  // The dominant axis and its sign select the face, and the other two components select the bin within the face
+  const std::size_t n_face_bins = grid.n_direction_divisions * grid.n_direction_divisions;
+  for (Eigen::Index axis = 0; axis < 3; ++axis)
+  {
+    for (double sign : { 1.0, -1.0 })
+    {
+      std::set<std::size_t> bins;
+      for (double u : { -0.5, 0.5 })
+      {
+        for (double v : { -0.5, 0.5 })
+        {
+          Eigen::Vector3d direction;
+          direction[axis] = sign;
+          direction[(axis + 1) % 3] = u;
+          direction[(axis + 2) % 3] = v;
+
+          const std::size_t bin = grid.getBin(direction);
+          EXPECT_EQ(bin / n_face_bins, std::size_t(2 * axis + (sign < 0.0 ? 1 : 0)));
+          bins.insert(bin);
+        }
+      }
+      EXPECT_EQ(bins.size(), n_face_bins);
+    }
+  }
+}
+
+TEST(CapabilityMap, SamplesDirectionsWithinBins)
+{
+  ik::CapabilityMap::Grid grid = createGrid();
+  for (std::uint32_t n : { 1, 2, 3 })
+  {
+    grid.n_direction_divisions = n;
+    std::mt19937 rng(0);
+    for (std::size_t bin = 0; bin < grid.getNumBins(); ++bin)
+    {
+      for (int i = 0; i < 100; ++i)
+      {
+        const Eigen::Vector3d direction = grid.sampleBinDirection(bin, rng);
+        EXPECT_NEAR(direction.norm(), 1.0, 1.0e-12);
+        EXPECT_EQ(grid.getBin(direction), bin);
+      }
+    }
+  }
+}
+
+TEST(CapabilityMap, IndexesVoxels)
+{
+  const ik::CapabilityMap::Grid grid = createGrid();
+  EXPECT_EQ(grid.getNumVoxels(), 500);
+
+  for (std::size_t voxel = 0; voxel < grid.getNumVoxels(); ++voxel)
+  {
+    std::size_t result;
+    ASSERT_TRUE(grid.getVoxel(grid.getVoxelCenter(voxel), result));
+    EXPECT_EQ(result, voxel);
+  }
+
+  std::size_t voxel;
+  EXPECT_FALSE(grid.getVoxel(Eigen::Vector3d(-0.51, 0.0, 0.1), voxel));
+  EXPECT_FALSE(grid.getVoxel(Eigen::Vector3d(0.0, 0.0, 0.5), voxel));
+}
+
+TEST(CapabilityMap, SavesAndLoads)
+{
+  const ik::CapabilityMap::Grid grid = createGrid();
+  std::vector<std::uint8_t> reachability(grid.getNumVoxels() * grid.getNumBins());
+  for (std::size_t i = 0; i < reachability.size(); ++i)
+    reachability[i] = static_cast<std::uint8_t>(i % 256);
+
+  TemporaryFile file;
+  ik::CapabilityMap::save(file.path.string(), grid, 0x0123456789abcdefULL, reachability);
+
+  const ik::CapabilityMap map(file.path.string());
+  EXPECT_TRUE(map.getGrid().origin.isApprox(grid.origin));
+  EXPECT_EQ(map.getGrid().resolution, grid.resolution);
+  EXPECT_EQ(map.getGrid().size, grid.size);
+  EXPECT_EQ(map.getGrid().n_direction_divisions, grid.n_direction_divisions);
+  EXPECT_EQ(map.getKinematicsHash(), 0x0123456789abcdefULL);
+
+  const std::size_t voxel = 123;
+  const Eigen::Vector3d direction(0.2, -0.1, 1.0);
+  const std::size_t bin = grid.getBin(direction);
+  const Eigen::Isometry3d pose = createPose(grid.getVoxelCenter(voxel), direction);
+  EXPECT_DOUBLE_EQ(map.getReachability(pose), double(reachability[voxel * grid.getNumBins() + bin]) / 255.0);
+
+  // Poses outside of the grid have negative reachability
+  EXPECT_LT(map.getReachability(createPose(Eigen::Vector3d(2.0, 0.0, 0.0), direction)), 0.0);
+}
+
+TEST(CapabilityMap, RejectsInvalidFiles)
+{
+  const ik::CapabilityMap::Grid grid = createGrid();
+  TemporaryFile file;
+
+  // Data that does not match the grid
+  EXPECT_THROW(ik::CapabilityMap::save(file.path.string(), grid, 0, std::vector<std::uint8_t>(10)),
+               std::runtime_error);
+
+  // A file that is not a capability map
+  {
+    std::ofstream stream(file.path.string(), std::ios::binary);
+    stream << std::string(128, 'x');
+  }
+  EXPECT_THROW(ik::CapabilityMap(file.path.string()), std::runtime_error);
+
+  // A truncated capability map
+  ik::CapabilityMap::save(file.path.string(), grid, 0,
+                          std::vector<std::uint8_t>(grid.getNumVoxels() * grid.getNumBins()));
+  boost::filesystem::resize_file(file.path, boost::filesystem::file_size(file.path) - 1);
+  EXPECT_THROW(ik::CapabilityMap(file.path.string()), std::runtime_error);
+}
+
+TEST(CapabilityMap, ComputesNeighborhoodReachability)
+{
+  const ik::CapabilityMap::Grid grid = createGrid();
+  const Eigen::Vector3d direction(0.2, 0.2, 1.0);
+  const Eigen::Vector3d center = grid.getVoxelCenter(0) + grid.resolution * Eigen::Vector3d(5.0, 5.0, 2.0);
+
+  // Make a single bin reachable
+  std::size_t reachable_voxel;
+  ASSERT_TRUE(grid.getVoxel(center, reachable_voxel));
+  std::vector<std::uint8_t> reachability(grid.getNumVoxels() * grid.getNumBins(), 0);
+  reachability[reachable_voxel * grid.getNumBins() + grid.getBin(direction)] = 255;
+
+  TemporaryFile file;
+  ik::CapabilityMap::save(file.path.string(), grid, 0, reachability);
+  const ik::CapabilityMap map(file.path.string());
+
+  // An unreachable bin of an adjacent voxel has a reachable neighbor
+  const Eigen::Isometry3d adjacent = createPose(center + grid.resolution * Eigen::Vector3d(1.0, 1.0, 0.0), direction);
+  EXPECT_EQ(map.getReachability(adjacent), 0.0);
+  EXPECT_EQ(map.getNeighborhoodReachability(adjacent), 1.0);
+
+  // So does an adjacent direction bin of the same voxel
+  const Eigen::Isometry3d tilted = createPose(center, Eigen::Vector3d(-0.4, 0.2, 1.0));
+  EXPECT_NE(grid.getBin(tilted.linear().col(2)), grid.getBin(direction));
+  EXPECT_EQ(map.getReachability(tilted), 0.0);
+  EXPECT_EQ(map.getNeighborhoodReachability(tilted), 1.0);
+
+  // Bins two voxels away are not neighbors
+  const Eigen::Isometry3d far = createPose(center + grid.resolution * Eigen::Vector3d(2.0, 0.0, 0.0), direction);
+  EXPECT_EQ(map.getNeighborhoodReachability(far), 0.0);
+
+  // Neighborhoods that extend outside of the grid are unknown
+  const Eigen::Isometry3d boundary = createPose(grid.getVoxelCenter(0), direction);
+  EXPECT_EQ(map.getReachability(boundary), 0.0);
+  EXPECT_LT(map.getNeighborhoodReachability(boundary), 0.0);
+}
+
+TEST(CapabilityMapIKSolver, ChecksKinematicsOfWrappedIKSolver)
+{
+  const ik::CapabilityMap::Grid grid = createGrid();
+  const std::vector<std::uint8_t> reachability(grid.getNumVoxels() * grid.getNumBins(), 0);
+  TemporaryFile file;
+  ik::CapabilityMap::save(file.path.string(), grid, KINEMATICS_HASH, reachability);
+
+  auto solver = std::make_shared<HashedIKSolver>();
+  EXPECT_NO_THROW(ik::CapabilityMapIKSolver(solver, file.path.string(), 0.0));
+
+  // Wrappers forward the kinematics of the IK solver they wrap
+  auto cached = std::make_shared<ik::CachingIKSolver>(solver, 1.0e-3, 1.0e-3, 1.0e-3, 1024);
+  EXPECT_EQ(cached->getKinematicsHash(), KINEMATICS_HASH);
+  EXPECT_NO_THROW(ik::CapabilityMapIKSolver(cached, file.path.string(), 0.0));
+
+  // IK solvers that cannot identify their kinematics, directly or through a wrapper, are rejected
+  auto unhashed = std::make_shared<NoSolutionIKSolver>();
+  EXPECT_THROW(ik::CapabilityMapIKSolver(unhashed, file.path.string(), 0.0), std::runtime_error);
+  EXPECT_THROW(ik::CapabilityMapIKSolver(std::make_shared<ik::CachingIKSolver>(unhashed, 1.0e-3, 1.0e-3, 1.0e-3, 1024),
+                                         file.path.string(), 0.0),
+               std::runtime_error);
+
+  // A map built for other kinematics is rejected
+  ik::CapabilityMap::save(file.path.string(), grid, KINEMATICS_HASH + 1, reachability);
+  EXPECT_THROW(ik::CapabilityMapIKSolver(cached, file.path.string(), 0.0), std::runtime_error);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
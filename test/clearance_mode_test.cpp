@@ -0,0 +1,47 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/clearance_mode.h>
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+
+using namespace reach_ros;
+
+TEST(ClearanceMode, ParsesParameter)
+{
+  EXPECT_EQ(collision::getClearanceMode(YAML::Load("{clearance_mode: distance}")), collision::ClearanceMode::DISTANCE);
+  EXPECT_EQ(collision::getClearanceMode(YAML::Load("{clearance_mode: padding}")), collision::ClearanceMode::PADDING);
+  EXPECT_EQ(collision::getClearanceMode(YAML::Load("{clearance_mode: sdf}")), collision::ClearanceMode::SDF);
+  EXPECT_EQ(collision::getClearanceMode(YAML::Load("{mode: sdf}"), "mode"), collision::ClearanceMode::SDF);
+}
+
+TEST(ClearanceMode, DefaultsToDistance)
+{
+  EXPECT_EQ(collision::getClearanceMode(YAML::Load("{}")), collision::ClearanceMode::DISTANCE);
+}
+
+TEST(ClearanceMode, RejectsInvalidParameter)
+{
+  EXPECT_THROW(collision::getClearanceMode(YAML::Load("{clearance_mode: SDF}")), std::runtime_error);
+  EXPECT_THROW(collision::getClearanceMode(YAML::Load("{clearance_mode: ''}")), std::runtime_error);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
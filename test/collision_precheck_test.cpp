@@ -0,0 +1,196 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/collision_precheck.h>
+#include <reach_ros/collision/link_spheres.h>
+#include <reach_ros/collision/signed_distance_field.h>
+
+#include <cmath>
+#include <geometric_shapes/shape_operations.h>
+#include <geometric_shapes/shapes.h>
+#include <gtest/gtest.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <vector>
+
+using namespace reach_ros;
+
+namespace
+{
+const std::string GROUP = "box";
+const std::string BOX_LINK = "box";
+const double BOX_SIZE = 0.1;
+const double PART_SIZE = 0.2;
+const double RESOLUTION = 0.01;
+
+geometry_msgs::Pose createIdentityPose()
+{
+  geometry_msgs::Pose pose;
+  pose.orientation.w = 1.0;
+  return pose;
+}
+
+/** @brief Builds a robot whose only link is a cube on a prismatic joint along the x-axis of the model frame */
+moveit::core::RobotModelPtr createBoxModel()
+{
+  moveit::core::RobotModelBuilder builder("box_robot", "base_link");
+  builder.addChain("base_link->" + BOX_LINK, "prismatic", { createIdentityPose() }, urdf::Vector3(1.0, 0.0, 0.0));
+  builder.addCollisionBox(BOX_LINK, { BOX_SIZE, BOX_SIZE, BOX_SIZE }, createIdentityPose());
+  builder.addGroupChain("base_link", BOX_LINK, GROUP);
+  return builder.build();
+}
+
+/** @brief Creates a cube centered on the origin, optionally without its face on the -z side */
+std::shared_ptr<shapes::Mesh> createCube(double size, bool open = false)
+{
+  EigenSTL::vector_Vector3d vertices;
+  for (unsigned int i = 0; i < 8; ++i)
+    vertices.push_back(0.5 * size * Eigen::Vector3d(i & 1 ? 1.0 : -1.0, i & 2 ? 1.0 : -1.0, i & 4 ? 1.0 : -1.0));
+
+  std::vector<unsigned int> triangles = { 0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+                                          2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5 };
+  if (open)
+    triangles.erase(triangles.begin(), triangles.begin() + 6);
+
+  return std::shared_ptr<shapes::Mesh>(shapes::createMeshFromVertices(vertices, triangles));
+}
+
+std::shared_ptr<const collision::SignedDistanceField> createPartField(double max_distance, bool open = false)
+{
+  return std::make_shared<const collision::SignedDistanceField>(*createCube(PART_SIZE, open),
+                                                                Eigen::Isometry3d::Identity(), RESOLUTION,
+                                                                max_distance);
+}
+
+/** @brief Returns the state of the box robot with the center of the box at the input x-coordinate */
+moveit::core::RobotState createState(const moveit::core::RobotModelConstPtr& model, double x)
+{
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+  state.setJointGroupPositions(model->getJointModelGroup(GROUP), std::vector<double>{ x });
+  state.update();
+  return state;
+}
+
+}  // namespace
+
+TEST(LinkSpheres, EnclosesLinks)
+{
+  const moveit::core::RobotModelPtr model = createBoxModel();
+  const collision::LinkSpheres spheres(model->getJointModelGroup(GROUP), {});
+  ASSERT_FALSE(spheres.getSpheres().empty());
+
+  // Every point of the box is within some sphere
+  for (double x = -0.5; x <= 0.5; x += 0.125)
+  {
+    for (double y = -0.5; y <= 0.5; y += 0.125)
+    {
+      for (double z = -0.5; z <= 0.5; z += 0.125)
+      {
+        const Eigen::Vector3d point = BOX_SIZE * Eigen::Vector3d(x, y, z);
+        bool enclosed = false;
+        for (const collision::LinkSpheres::Sphere& sphere : spheres.getSpheres())
+          enclosed = enclosed || (point - sphere.center).norm() <= sphere.radius + 1.0e-9;
+        EXPECT_TRUE(enclosed) << "Point " << point.transpose();
+      }
+    }
+  }
+}
+
+TEST(LinkSpheres, UnderestimatesDistance)
+{
+  const moveit::core::RobotModelPtr model = createBoxModel();
+  const collision::LinkSpheres spheres(model->getJointModelGroup(GROUP), {});
+  const std::shared_ptr<const collision::SignedDistanceField> sdf = createPartField(0.5);
+  const double error = std::sqrt(3.0) * RESOLUTION;
+
+  for (double x : { 0.2, 0.3, 0.4 })
+  {
+    const moveit::core::RobotState state = createState(model, x);
+    const double exact = x - 0.5 * (BOX_SIZE + PART_SIZE);
+    const double distance = spheres.getDistance(state, *sdf);
+    EXPECT_LE(distance, exact + error) << "Position " << x;
+
+    // The spheres of a cube exceed it by less than its half diagonal
+    EXPECT_GT(distance, exact - std::sqrt(3.0) * 0.5 * BOX_SIZE - error) << "Position " << x;
+
+    // The bounding sphere may be decided on either side of the nearest sphere within the interpolation error
+    EXPECT_TRUE(spheres.isClearOf(state, *sdf, distance - 1.0e-9)) << "Position " << x;
+    EXPECT_FALSE(spheres.isClearOf(state, *sdf, distance + 2.0 * error + 1.0e-6)) << "Position " << x;
+  }
+}
+
+TEST(LinkSpheres, ExcludesLinks)
+{
+  const moveit::core::RobotModelPtr model = createBoxModel();
+  EXPECT_TRUE(collision::LinkSpheres(model->getJointModelGroup(GROUP), { BOX_LINK }).getSpheres().empty());
+}
+
+TEST(CollisionPrecheck, DecidesBoxStates)
+{
+  const moveit::core::RobotModelPtr model = createBoxModel();
+  const collision::CollisionPrecheck precheck(createPartField(0.2), model->getJointModelGroup(GROUP), {});
+
+  // Far from the part
+  EXPECT_EQ(precheck.check(createState(model, 0.5)), collision::CollisionPrecheck::Result::FREE);
+
+  // Edges of the box cross the face of the part at x = 0.1
+  EXPECT_EQ(precheck.check(createState(model, 0.1)), collision::CollisionPrecheck::Result::COLLIDING);
+
+  // Close to the part, but not touching it
+  EXPECT_EQ(precheck.check(createState(model, 0.17)), collision::CollisionPrecheck::Result::UNKNOWN);
+
+  // Within the part, where no edge crosses its surface
+  EXPECT_EQ(precheck.check(createState(model, 0.0)), collision::CollisionPrecheck::Result::UNKNOWN);
+}
+
+TEST(CollisionPrecheck, RespectsPadding)
+{
+  const moveit::core::RobotModelPtr model = createBoxModel();
+  const moveit::core::RobotState state = createState(model, 0.5);
+
+  // The distances saturate at the maximum distance of the field, so a state is never free if its spheres plus the
+  // padding cannot fit within it
+  const collision::CollisionPrecheck padded(createPartField(0.2), model->getJointModelGroup(GROUP), {}, 0.2);
+  EXPECT_EQ(padded.check(state), collision::CollisionPrecheck::Result::UNKNOWN);
+
+  const collision::CollisionPrecheck wide(createPartField(0.5), model->getJointModelGroup(GROUP), {}, 0.2);
+  EXPECT_EQ(wide.check(state), collision::CollisionPrecheck::Result::FREE);
+}
+
+TEST(CollisionPrecheck, NeverCollidesWithOpenMesh)
+{
+  const moveit::core::RobotModelPtr model = createBoxModel();
+  const std::shared_ptr<const collision::SignedDistanceField> sdf = createPartField(0.2, true);
+  ASSERT_FALSE(sdf->isClosed());
+
+  const collision::CollisionPrecheck precheck(sdf, model->getJointModelGroup(GROUP), {});
+  EXPECT_EQ(precheck.check(createState(model, 0.5)), collision::CollisionPrecheck::Result::FREE);
+  EXPECT_EQ(precheck.check(createState(model, 0.1)), collision::CollisionPrecheck::Result::UNKNOWN);
+}
+
+TEST(CollisionPrecheck, ExcludesLinks)
+{
+  const moveit::core::RobotModelPtr model = createBoxModel();
+  const collision::CollisionPrecheck precheck(createPartField(0.2), model->getJointModelGroup(GROUP), { BOX_LINK });
+  EXPECT_EQ(precheck.check(createState(model, 0.1)), collision::CollisionPrecheck::Result::FREE);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/collision_scope.h>
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <yaml-cpp/yaml.h>
+
+using namespace reach_ros;
+
+TEST(CollisionScope, ParsesParameter)
+{
+  const collision::CollisionScope def = collision::CollisionScope::BOTH;
+  EXPECT_EQ(collision::getCollisionScope(YAML::Load("{collision_scope: world}"), def),
+            collision::CollisionScope::WORLD);
+  EXPECT_EQ(collision::getCollisionScope(YAML::Load("{collision_scope: self}"), def), collision::CollisionScope::SELF);
+  EXPECT_EQ(collision::getCollisionScope(YAML::Load("{collision_scope: both}"), collision::CollisionScope::WORLD),
+            collision::CollisionScope::BOTH);
+  EXPECT_EQ(collision::getCollisionScope(YAML::Load("{scope: self}"), def, "scope"), collision::CollisionScope::SELF);
+}
+
+TEST(CollisionScope, DefaultsToInputScope)
+{
+  EXPECT_EQ(collision::getCollisionScope(YAML::Load("{}"), collision::CollisionScope::BOTH),
+            collision::CollisionScope::BOTH);
+  EXPECT_EQ(collision::getCollisionScope(YAML::Load("{}"), collision::CollisionScope::WORLD),
+            collision::CollisionScope::WORLD);
+}
+
+TEST(CollisionScope, RejectsInvalidParameter)
+{
+  const collision::CollisionScope def = collision::CollisionScope::BOTH;
+  EXPECT_THROW(collision::getCollisionScope(YAML::Load("{collision_scope: World}"), def), std::runtime_error);
+  EXPECT_THROW(collision::getCollisionScope(YAML::Load("{collision_scope: ''}"), def), std::runtime_error);
+  EXPECT_THROW(collision::getCollisionScope(YAML::Load("{collision_scope: [world, self]}"), def), std::runtime_error);
+}
+
+TEST(CollisionScope, IncludesEnvironments)
+{
+  EXPECT_TRUE(collision::includesWorld(collision::CollisionScope::WORLD));
+  EXPECT_FALSE(collision::includesSelf(collision::CollisionScope::WORLD));
+  EXPECT_FALSE(collision::includesWorld(collision::CollisionScope::SELF));
+  EXPECT_TRUE(collision::includesSelf(collision::CollisionScope::SELF));
+  EXPECT_TRUE(collision::includesWorld(collision::CollisionScope::BOTH));
+  EXPECT_TRUE(collision::includesSelf(collision::CollisionScope::BOTH));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
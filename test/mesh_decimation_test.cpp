@@ -0,0 +1,253 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/mesh_decimation.h>
+
+#include <algorithm>
+#include <cmath>
+#include <geometric_shapes/shape_operations.h>
+#include <geometric_shapes/shapes.h>
+#include <gtest/gtest.h>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+using namespace reach_ros;
+
+namespace
+{
+/** @brief Creates a sphere of latitude and longitude bands */
+std::shared_ptr<shapes::Mesh> createSphere(double radius, unsigned int n_bands)
+{
+  EigenSTL::vector_Vector3d vertices;
+  for (unsigned int i = 0; i <= n_bands; ++i)
+  {
+    const double theta = M_PI * i / n_bands;
+    for (unsigned int j = 0; j < 2 * n_bands; ++j)
+    {
+      const double phi = M_PI * j / n_bands;
+      const Eigen::Vector3d normal(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+      vertices.push_back(radius * normal);
+    }
+  }
+
+  std::vector<unsigned int> triangles;
+  for (unsigned int i = 0; i < n_bands; ++i)
+  {
+    for (unsigned int j = 0; j < 2 * n_bands; ++j)
+    {
+      const unsigned int a = i * 2 * n_bands + j;
+      const unsigned int b = i * 2 * n_bands + (j + 1) % (2 * n_bands);
+      triangles.insert(triangles.end(), { a, a + 2 * n_bands, b, b, a + 2 * n_bands, b + 2 * n_bands });
+    }
+  }
+
+  return std::shared_ptr<shapes::Mesh>(shapes::createMeshFromVertices(vertices, triangles));
+}
+
+/**
+ * @brief Creates a square plate of the input size and thickness, centered on the origin, whose top and bottom faces
+ * are grids of the input number of squares per side (without side faces)
+ */
+std::shared_ptr<shapes::Mesh> createPlate(double size, double thickness, unsigned int n_squares)
+{
+  EigenSTL::vector_Vector3d vertices;
+  std::vector<unsigned int> triangles;
+  for (double z : { -0.5 * thickness, 0.5 * thickness })
+  {
+    const auto offset = static_cast<unsigned int>(vertices.size());
+    for (unsigned int i = 0; i <= n_squares; ++i)
+      for (unsigned int j = 0; j <= n_squares; ++j)
+        vertices.push_back(
+            Eigen::Vector3d(size * (double(i) / n_squares - 0.5), size * (double(j) / n_squares - 0.5), z));
+
+    for (unsigned int i = 0; i < n_squares; ++i)
+    {
+      for (unsigned int j = 0; j < n_squares; ++j)
+      {
+        const unsigned int a = offset + i * (n_squares + 1) + j;
+        const unsigned int b = a + n_squares + 1;
+        triangles.insert(triangles.end(), { a, b, b + 1, a, b + 1, a + 1 });
+      }
+    }
+  }
+
+  return std::shared_ptr<shapes::Mesh>(shapes::createMeshFromVertices(vertices, triangles));
+}
+
+Eigen::Vector3d getVertex(const shapes::Mesh& mesh, std::size_t triangle, std::size_t corner)
+{
+  const unsigned int i = mesh.triangles[3 * triangle + corner];
+  return Eigen::Vector3d(mesh.vertices[3 * i], mesh.vertices[3 * i + 1], mesh.vertices[3 * i + 2]);
+}
+
+/** @brief Computes the distance between a point and a triangle (see Ericson, Real-Time Collision Detection, 5.1.5) */
+double getDistance(const Eigen::Vector3d& p, const Eigen::Vector3d& a, const Eigen::Vector3d& b,
+                   const Eigen::Vector3d& c)
+{
+  const Eigen::Vector3d ab = b - a;
+  const Eigen::Vector3d ac = c - a;
+  const Eigen::Vector3d ap = p - a;
+  const double d1 = ab.dot(ap);
+  const double d2 = ac.dot(ap);
+  if (d1 <= 0.0 && d2 <= 0.0)
+    return ap.norm();
+
+  const Eigen::Vector3d bp = p - b;
+  const double d3 = ab.dot(bp);
+  const double d4 = ac.dot(bp);
+  if (d3 >= 0.0 && d4 <= d3)
+    return bp.norm();
+
+  const double vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+    return (p - (a + d1 / (d1 - d3) * ab)).norm();
+
+  const Eigen::Vector3d cp = p - c;
+  const double d5 = ab.dot(cp);
+  const double d6 = ac.dot(cp);
+  if (d6 >= 0.0 && d5 <= d6)
+    return cp.norm();
+
+  const double vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+    return (p - (a + d2 / (d2 - d6) * ac)).norm();
+
+  const double va = d3 * d6 - d5 * d4;
+  if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+    return (p - (b + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (c - b))).norm();
+
+  const double denom = 1.0 / (va + vb + vc);
+  return (p - (a + ab * vb * denom + ac * vc * denom)).norm();
+}
+
+/**
+ * @brief Computes the largest distance between points sampled on the triangles of the original mesh (at their
+ * vertices, edge midpoints, and centroids) and the simplified mesh
+ */
+double getMaxDeviation(const shapes::Mesh& original, const shapes::Mesh& simplified)
+{
+  double max_deviation = 0.0;
+  for (std::size_t i = 0; i < original.triangle_count; ++i)
+  {
+    const Eigen::Vector3d a = getVertex(original, i, 0);
+    const Eigen::Vector3d b = getVertex(original, i, 1);
+    const Eigen::Vector3d c = getVertex(original, i, 2);
+    for (const Eigen::Vector3d& p : { a, b, c, Eigen::Vector3d(0.5 * (a + b)), Eigen::Vector3d(0.5 * (b + c)),
+                                      Eigen::Vector3d(0.5 * (c + a)), Eigen::Vector3d((a + b + c) / 3.0) })
+    {
+      double distance = std::numeric_limits<double>::max();
+      for (std::size_t j = 0; j < simplified.triangle_count; ++j)
+        distance = std::min(distance, getDistance(p, getVertex(simplified, j, 0), getVertex(simplified, j, 1),
+                                                  getVertex(simplified, j, 2)));
+      max_deviation = std::max(max_deviation, distance);
+    }
+  }
+  return max_deviation;
+}
+
+}  // namespace
+
+TEST(MeshDecimation, EnclosesMeshWithinTolerance)
+{
+  const std::shared_ptr<shapes::Mesh> mesh = createSphere(0.1, 24);
+
+  collision::MeshDecimation decimation;
+  decimation.tolerance = 0.01;
+  double error;
+  const std::shared_ptr<const shapes::Mesh> simplified = collision::decimateMesh(*mesh, decimation, error);
+
+  EXPECT_LT(simplified->triangle_count, mesh->triangle_count);
+  EXPECT_GT(error, 0.0);
+  EXPECT_LE(error, decimation.tolerance);
+  EXPECT_LE(getMaxDeviation(*mesh, *simplified), error + 1.0e-9);
+}
+
+TEST(MeshDecimation, MeetsMaxTriangles)
+{
+  const std::shared_ptr<shapes::Mesh> mesh = createSphere(0.1, 24);
+
+  collision::MeshDecimation decimation;
+  decimation.max_triangles = 1000;
+  double error;
+  const std::shared_ptr<const shapes::Mesh> simplified = collision::decimateMesh(*mesh, decimation, error);
+
+  EXPECT_LE(simplified->triangle_count, decimation.max_triangles);
+  EXPECT_GT(error, 0.0);
+  EXPECT_LE(getMaxDeviation(*mesh, *simplified), error + 1.0e-9);
+
+  // The cell size is the smallest that meets the triangle count, so a slightly smaller error exceeds it
+  decimation.tolerance = 0.9 * error;
+  EXPECT_THROW(collision::decimateMesh(*mesh, decimation, error), std::runtime_error);
+}
+
+TEST(MeshDecimation, KeepsThinFeatures)
+{
+  // A plate much thinner than the grid cells, whose top and bottom would collapse onto each other
+  const std::shared_ptr<shapes::Mesh> mesh = createPlate(0.2, 0.001, 40);
+
+  collision::MeshDecimation decimation;
+  decimation.tolerance = 0.01;
+  double error;
+  const std::shared_ptr<const shapes::Mesh> simplified = collision::decimateMesh(*mesh, decimation, error);
+
+  EXPECT_LT(simplified->triangle_count, mesh->triangle_count);
+  EXPECT_LE(getMaxDeviation(*mesh, *simplified), error + 1.0e-9);
+}
+
+TEST(MeshDecimation, KeepsSmallerOriginalMesh)
+{
+  // The simplified mesh of a coarse mesh has more triangles than the original mesh, which is exact
+  const std::shared_ptr<shapes::Mesh> mesh = createPlate(0.2, 0.05, 1);
+
+  collision::MeshDecimation decimation;
+  decimation.tolerance = 0.01;
+  double error;
+  const std::shared_ptr<const shapes::Mesh> simplified = collision::decimateMesh(*mesh, decimation, error);
+
+  EXPECT_EQ(simplified->triangle_count, mesh->triangle_count);
+  EXPECT_EQ(error, 0.0);
+}
+
+TEST(MeshDecimation, ThrowsIfMaxTrianglesCannotBeMet)
+{
+  const std::shared_ptr<shapes::Mesh> mesh = createSphere(0.1, 24);
+
+  collision::MeshDecimation decimation;
+  decimation.max_triangles = 100;
+  decimation.tolerance = 0.001;
+  double error;
+  EXPECT_THROW(collision::decimateMesh(*mesh, decimation, error), std::runtime_error);
+}
+
+TEST(MeshDecimation, ParsesParameters)
+{
+  YAML::Node config = YAML::Load("{collision_mesh_decimation: {max_triangles: 500, tolerance: -0.002}}");
+  const collision::MeshDecimation decimation = collision::getMeshDecimation(config);
+  EXPECT_EQ(decimation.max_triangles, 500u);
+  EXPECT_DOUBLE_EQ(decimation.tolerance, 0.002);
+  EXPECT_FALSE(decimation.coarse_fine);
+
+  EXPECT_FALSE(collision::getMeshDecimation(YAML::Load("{}")).enabled());
+  EXPECT_THROW(collision::getMeshDecimation(YAML::Load("{collision_mesh_decimation: {coarse_fine: true}}")),
+               std::runtime_error);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,360 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/signed_distance_field.h>
+#include <reach_ros/ik/moveit_ik_solver.h>
+#include <reach_ros/utils.h>
+
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <moveit/common_planning_interface_objects/common_objects.h>
+#include <moveit/kinematics_base/kinematics_base.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <random_numbers/random_numbers.h>
+#include <ros/init.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+using namespace reach_ros;
+
+namespace
+{
+/** @brief Planning group of the demo robot, whose description is loaded by the test launch file */
+const std::string PLANNING_GROUP = "manipulator";
+
+/** @brief Collision mesh of the demo part */
+const std::string MESH_FILENAME = "package://reach_ros/demo/config/part.ply";
+const std::string MESH_FRAME = "base_link";
+
+moveit::core::RobotModelConstPtr getModel()
+{
+  moveit::core::RobotModelConstPtr model = moveit::planning_interface::getSharedRobotModel("robot_description");
+  if (!model)
+    throw std::runtime_error("Failed to load the demo robot model");
+  return model;
+}
+
+std::string getTipFrame(const moveit::core::JointModelGroup* jmg)
+{
+  std::string tip_frame = jmg->getSolverInstance()->getTipFrame();
+  if (!tip_frame.empty() && tip_frame.front() == '/')
+    tip_frame.erase(0, 1);
+  return tip_frame;
+}
+
+/** @brief Kinematics solver that never finds a solution, for test models without a kinematics plugin */
+class NoSolutionKinematics : public kinematics::KinematicsBase
+{
+public:
+  NoSolutionKinematics(const moveit::core::JointModelGroup* jmg, const std::string& tip_frame)
+    : joint_names_(jmg->getActiveJointModelNames()), link_names_({ tip_frame })
+  {
+    storeValues(jmg->getParentModel(), jmg->getName(), jmg->getParentModel().getModelFrame(), { tip_frame }, 0.1);
+  }
+
+  bool getPositionIK(const geometry_msgs::Pose&, const std::vector<double>&, std::vector<double>&,
+                     moveit_msgs::MoveItErrorCodes& error_code,
+                     const kinematics::KinematicsQueryOptions&) const override
+  {
+    error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+    return false;
+  }
+
+  bool searchPositionIK(const geometry_msgs::Pose& pose, const std::vector<double>& seed, double,
+                        std::vector<double>& solution, moveit_msgs::MoveItErrorCodes& error_code,
+                        const kinematics::KinematicsQueryOptions& options) const override
+  {
+    return getPositionIK(pose, seed, solution, error_code, options);
+  }
+
+  bool searchPositionIK(const geometry_msgs::Pose& pose, const std::vector<double>& seed, double,
+                        const std::vector<double>&, std::vector<double>& solution,
+                        moveit_msgs::MoveItErrorCodes& error_code,
+                        const kinematics::KinematicsQueryOptions& options) const override
+  {
+    return getPositionIK(pose, seed, solution, error_code, options);
+  }
+
+  bool searchPositionIK(const geometry_msgs::Pose& pose, const std::vector<double>& seed, double,
+                        std::vector<double>& solution, const IKCallbackFn&, moveit_msgs::MoveItErrorCodes& error_code,
+                        const kinematics::KinematicsQueryOptions& options) const override
+  {
+    return getPositionIK(pose, seed, solution, error_code, options);
+  }
+
+  bool searchPositionIK(const geometry_msgs::Pose& pose, const std::vector<double>& seed, double,
+                        const std::vector<double>&, std::vector<double>& solution, const IKCallbackFn&,
+                        moveit_msgs::MoveItErrorCodes& error_code,
+                        const kinematics::KinematicsQueryOptions& options) const override
+  {
+    return getPositionIK(pose, seed, solution, error_code, options);
+  }
+
+  bool getPositionFK(const std::vector<std::string>&, const std::vector<double>&,
+                     std::vector<geometry_msgs::Pose>&) const override
+  {
+    return false;
+  }
+
+  const std::vector<std::string>& getJointNames() const override
+  {
+    return joint_names_;
+  }
+
+  const std::vector<std::string>& getLinkNames() const override
+  {
+    return link_names_;
+  }
+
+private:
+  std::vector<std::string> joint_names_;
+  std::vector<std::string> link_names_;
+};
+
+/**
+ * @brief Builds a robot whose planning group is a single prismatic joint without position limits, such that its
+ * workspace envelope cannot be bounded
+ */
+moveit::core::RobotModelPtr createUnboundedModel()
+{
+  geometry_msgs::Pose origin;
+  origin.orientation.w = 1.0;
+
+  moveit::core::RobotModelBuilder builder("slider", "base_link");
+  builder.addChain("base_link->tip", "prismatic", { origin }, urdf::Vector3(1.0, 0.0, 0.0));
+  builder.addGroupChain("base_link", "tip", "slider");
+  moveit::core::RobotModelPtr model = builder.build();
+
+  moveit::core::JointModel* joint = model->getJointModel(model->getLinkModel("tip")->getParentJointModel()->getName());
+  moveit::core::VariableBounds bounds = joint->getVariableBounds().front();
+  bounds.position_bounded_ = false;
+  joint->setVariableBounds(joint->getName(), bounds);
+
+  model->getJointModelGroup("slider")->setSolverAllocators([](const moveit::core::JointModelGroup* jmg) {
+    return std::make_shared<NoSolutionKinematics>(jmg, "tip");
+  });
+  return model;
+}
+
+/** @brief Returns a seed of all zeros for the active joints of a planning group */
+std::map<std::string, double> createZeroSeed(const moveit::core::JointModelGroup* jmg)
+{
+  std::map<std::string, double> seed;
+  for (const std::string& name : jmg->getActiveJointModelNames())
+    seed[name] = 0.0;
+  return seed;
+}
+
+}  // namespace
+
+TEST(MoveItIKSolver, ReusesSignedDistanceField)
+{
+  const moveit::core::RobotModelConstPtr model = getModel();
+  const double resolution = 0.02;
+
+  ik::MoveItIKSolver solver(model, PLANNING_GROUP, 0.0);
+  solver.addCollisionMesh(MESH_FILENAME, MESH_FRAME);
+  solver.setSignedDistanceField(resolution, 0.0);
+  solver.setCollisionPrecheck(true);
+
+  // Only the solver holds the field, so the registry entry expires if the solver ever releases it
+  const double max_distance = 2.0 * resolution;
+  std::weak_ptr<const collision::SignedDistanceField> sdf =
+      utils::getSignedDistanceField(model, MESH_FILENAME, MESH_FRAME, resolution, max_distance);
+  ASSERT_FALSE(sdf.expired());
+
+  // Updating the field with unchanged parameters keeps the same instance
+  solver.setSignedDistanceField(resolution, 0.0);
+  solver.setCollisionPrecheck(true);
+  ASSERT_FALSE(sdf.expired());
+  EXPECT_EQ(sdf.lock(), utils::getSignedDistanceField(model, MESH_FILENAME, MESH_FRAME, resolution, max_distance));
+}
+
+TEST(MoveItIKSolver, SolvesConcurrently)
+{
+  // Several threads share one solver, and thereby its collision environments, while each solves with its own context.
+  // Run under ThreadSanitizer to check for data races (see the README)
+  const moveit::core::RobotModelConstPtr model = getModel();
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(PLANNING_GROUP);
+  const std::string tip_frame = getTipFrame(jmg);
+
+  ik::MoveItIKSolver solver(model, PLANNING_GROUP, 0.0);
+  solver.addCollisionMesh(MESH_FILENAME, MESH_FRAME);
+  solver.setNumSeedThreads(2);
+  solver.setNumRandomSeeds(2);
+
+  std::map<std::string, double> seed;
+  for (const std::string& name : jmg->getActiveJointModelNames())
+    seed[name] = 0.0;
+
+  // Targets at the tip of the robot in random states
+  random_numbers::RandomNumberGenerator rng(0);
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+  std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> targets;
+  for (std::size_t i = 0; i < 32; ++i)
+  {
+    state.setToRandomPositions(jmg, rng);
+    state.update();
+    targets.push_back(state.getGlobalLinkTransform(tip_frame));
+  }
+
+  const std::size_t n_threads = 8;
+  std::vector<std::vector<std::vector<std::vector<double>>>> solutions(
+      n_threads, std::vector<std::vector<std::vector<double>>>(targets.size()));
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < n_threads; ++t)
+  {
+    threads.emplace_back([&, t]() {
+      for (std::size_t i = 0; i < targets.size(); ++i)
+        solutions[t][(i + t) % targets.size()] = solver.solveIK(targets[(i + t) % targets.size()], seed);
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  // Every solution reaches its target, whichever thread solved it
+  std::size_t n_solved = 0;
+  for (std::size_t t = 0; t < n_threads; ++t)
+  {
+    for (std::size_t i = 0; i < targets.size(); ++i)
+    {
+      for (const std::vector<double>& solution : solutions[t][i])
+      {
+        state.setJointGroupPositions(jmg, solution);
+        state.update();
+        const Eigen::Isometry3d& pose = state.getGlobalLinkTransform(tip_frame);
+        EXPECT_LT((pose.translation() - targets[i].translation()).norm(), 1.0e-3) << "Target " << i;
+        EXPECT_LT(Eigen::AngleAxisd(pose.linear().transpose() * targets[i].linear()).angle(), 1.0e-2)
+            << "Target " << i;
+      }
+      n_solved += solutions[t][i].empty() ? 0 : 1;
+    }
+  }
+  EXPECT_GT(n_solved, 0u);
+}
+
+TEST(MoveItIKSolver, RejectsTargetsOutsideOfWorkspaceEnvelope)
+{
+  const moveit::core::RobotModelConstPtr model = getModel();
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(PLANNING_GROUP);
+  const std::map<std::string, double> seed = createZeroSeed(jmg);
+  const Eigen::Isometry3d far_target(Eigen::Translation3d(100.0, 0.0, 0.0));
+
+  ik::MoveItIKSolver solver(model, PLANNING_GROUP, 0.0);
+  EXPECT_TRUE(solver.solveIK(far_target, seed).empty());
+  EXPECT_EQ(solver.getValidityStatistics().envelope_rejections, 1u);
+
+  // A reachable target is within the envelope
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+  state.update();
+  EXPECT_FALSE(solver.solveIK(state.getGlobalLinkTransform(getTipFrame(jmg)), seed).empty());
+  EXPECT_EQ(solver.getValidityStatistics().envelope_rejections, 1u);
+
+  // Rotating a target about its Z-axis does not change its position, so the discretized solver rejects it up front
+  ik::DiscretizedMoveItIKSolver discretized(model, PLANNING_GROUP, 0.0, M_PI / 2.0);
+  EXPECT_TRUE(discretized.solveIK(far_target, seed).empty());
+  EXPECT_EQ(discretized.getValidityStatistics().envelope_rejections, 1u);
+}
+
+TEST(MoveItIKSolver, DisablesWorkspaceEnvelope)
+{
+  const moveit::core::RobotModelConstPtr model = getModel();
+  const std::map<std::string, double> seed = createZeroSeed(model->getJointModelGroup(PLANNING_GROUP));
+
+  ik::MoveItIKSolver solver(model, PLANNING_GROUP, 0.0);
+  solver.setWorkspaceEnvelope(false);
+  EXPECT_TRUE(solver.solveIK(Eigen::Isometry3d(Eigen::Translation3d(100.0, 0.0, 0.0)), seed).empty());
+  EXPECT_EQ(solver.getValidityStatistics().envelope_rejections, 0u);
+}
+
+TEST(MoveItIKSolver, AcceptsTargetsWithoutWorkspaceEnvelope)
+{
+  // The envelope of a planning group with an unlimited prismatic joint is unavailable, so no target is rejected by it
+  const moveit::core::RobotModelPtr model = createUnboundedModel();
+  const std::map<std::string, double> seed = createZeroSeed(model->getJointModelGroup("slider"));
+
+  ik::MoveItIKSolver solver(model, "slider", 0.0);
+  EXPECT_TRUE(solver.solveIK(Eigen::Isometry3d(Eigen::Translation3d(1.0e6, 0.0, 0.0)), seed).empty());
+  EXPECT_EQ(solver.getValidityStatistics().envelope_rejections, 0u);
+}
+
+TEST(DiscretizedMoveItIKSolverFactory, RejectsConflictingStrategies)
+{
+  const ik::DiscretizedMoveItIKSolverFactory factory;
+  auto create = [&factory](const std::string& options) {
+    return factory.create(YAML::Load("{planning_group: " + PLANNING_GROUP +
+                                     ", distance_threshold: 0.0, discretization_angle: 0.5" + options + "}"));
+  };
+
+  EXPECT_NO_THROW(create(", wrist_axis_shortcut: true"));
+  EXPECT_NO_THROW(create(", adaptive_discretization: true, coarse_discretization_angle: 1.0"));
+  EXPECT_NO_THROW(create(", adaptive_discretization: true, wrist_axis_shortcut: false"));
+
+  EXPECT_THROW(create(", wrist_axis_shortcut: true, adaptive_discretization: true"), std::runtime_error);
+  EXPECT_THROW(create(", adaptive_discretization: true, discretization_continuation: true"), std::runtime_error);
+  EXPECT_THROW(create(", wrist_axis_shortcut: true, discretization_continuation: true"), std::runtime_error);
+  EXPECT_THROW(create(", coarse_discretization_angle: 1.0"), std::runtime_error);
+}
+
+TEST(DiscretizedMoveItIKSolver, AdaptiveReturnsCoarseSamplesOfFeasibleRanges)
+{
+  const moveit::core::RobotModelConstPtr model = getModel();
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup(PLANNING_GROUP);
+  const std::string tip_frame = getTipFrame(jmg);
+
+  // Four discretizations, of which every other one is a coarse sample
+  ik::DiscretizedMoveItIKSolver uniform(model, PLANNING_GROUP, 0.0, M_PI / 2.0);
+  ik::DiscretizedMoveItIKSolver adaptive(model, PLANNING_GROUP, 0.0, M_PI / 2.0);
+  adaptive.setAdaptive(true, M_PI);
+
+  // Find a target at the tip of the robot in a random state at which every discretization is feasible
+  random_numbers::RandomNumberGenerator rng(0);
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+  for (std::size_t i = 0; i < 64; ++i)
+  {
+    state.setToRandomPositions(jmg, rng);
+    state.update();
+    const Eigen::Isometry3d target = state.getGlobalLinkTransform(tip_frame);
+
+    std::map<std::string, double> seed;
+    for (const std::string& name : jmg->getActiveJointModelNames())
+      seed[name] = state.getVariablePosition(name);
+
+    if (uniform.solveIK(target, seed).size() < 4)
+      continue;
+
+    // The feasible intervals between the coarse samples are not refined
+    EXPECT_EQ(adaptive.solveIK(target, seed).size(), 2u);
+    return;
+  }
+
+  FAIL() << "No target was found at which every discretization is feasible";
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "moveit_ik_solver_test");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/seed_cache.h>
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+
+using namespace reach_ros;
+
+namespace
+{
+Eigen::Isometry3d createTarget(double x, double y, double z, double angle = 0.0)
+{
+  return Eigen::Translation3d(x, y, z) * Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ());
+}
+
+}  // namespace
+
+TEST(SeedCache, RejectsNonPositiveResolution)
+{
+  EXPECT_THROW(ik::SeedCache(0.0), std::runtime_error);
+  EXPECT_THROW(ik::SeedCache(-0.1), std::runtime_error);
+}
+
+TEST(SeedCache, ReturnsNoSeedsWhenEmpty)
+{
+  ik::SeedCache cache(0.1);
+  EXPECT_TRUE(cache.getSeeds(createTarget(0.0, 0.0, 0.0), 3).empty());
+}
+
+TEST(SeedCache, OrdersSeedsByDistance)
+{
+  ik::SeedCache cache(0.1);
+  cache.insert(createTarget(0.08, 0.0, 0.0), { 3.0 });
+  cache.insert(createTarget(0.01, 0.0, 0.0), { 1.0 });
+  cache.insert(createTarget(0.05, 0.0, 0.0), { 2.0 });
+
+  const std::vector<std::vector<double>> seeds = cache.getSeeds(createTarget(0.0, 0.0, 0.0), 3);
+  ASSERT_EQ(seeds.size(), 3);
+  EXPECT_EQ(seeds[0], std::vector<double>{ 1.0 });
+  EXPECT_EQ(seeds[1], std::vector<double>{ 2.0 });
+  EXPECT_EQ(seeds[2], std::vector<double>{ 3.0 });
+
+  // Only the requested number of seeds is returned
+  const std::vector<std::vector<double>> nearest = cache.getSeeds(createTarget(0.0, 0.0, 0.0), 1);
+  ASSERT_EQ(nearest.size(), 1);
+  EXPECT_EQ(nearest[0], std::vector<double>{ 1.0 });
+}
+
+TEST(SeedCache, SearchesAdjacentVoxelsOnly)
+{
+  ik::SeedCache cache(0.1);
+
+  // Adjacent voxels, including across the origin where the voxel index changes sign
+  cache.insert(createTarget(-0.01, 0.0, 0.0), { 1.0 });
+  cache.insert(createTarget(0.15, 0.15, 0.15), { 2.0 });
+
+  // Two voxels away
+  cache.insert(createTarget(0.25, 0.0, 0.0), { 3.0 });
+
+  const std::vector<std::vector<double>> seeds = cache.getSeeds(createTarget(0.05, 0.05, 0.05), 3);
+  ASSERT_EQ(seeds.size(), 2);
+  EXPECT_EQ(seeds[0], std::vector<double>{ 1.0 });
+  EXPECT_EQ(seeds[1], std::vector<double>{ 2.0 });
+}
+
+TEST(SeedCache, PenalizesOrientationDifference)
+{
+  ik::SeedCache cache(0.1);
+  cache.insert(createTarget(0.0, 0.0, 0.0, M_PI), { 1.0 });
+  cache.insert(createTarget(0.02, 0.0, 0.0), { 2.0 });
+
+  // The coincident target is rotated by pi, which costs pi times the resolution, more than the 0.02 offset
+  const std::vector<std::vector<double>> seeds = cache.getSeeds(createTarget(0.0, 0.0, 0.0), 2);
+  ASSERT_EQ(seeds.size(), 2);
+  EXPECT_EQ(seeds[0], std::vector<double>{ 2.0 });
+  EXPECT_EQ(seeds[1], std::vector<double>{ 1.0 });
+}
+
+TEST(SeedCache, RetainsMostRecentEntriesPerVoxel)
+{
+  ik::SeedCache cache(1.0, 2);
+  cache.insert(createTarget(0.1, 0.0, 0.0), { 1.0 });
+  cache.insert(createTarget(0.2, 0.0, 0.0), { 2.0 });
+  cache.insert(createTarget(0.3, 0.0, 0.0), { 3.0 });
+
+  const std::vector<std::vector<double>> seeds = cache.getSeeds(createTarget(0.0, 0.0, 0.0), 3);
+  ASSERT_EQ(seeds.size(), 2);
+  EXPECT_EQ(seeds[0], std::vector<double>{ 2.0 });
+  EXPECT_EQ(seeds[1], std::vector<double>{ 3.0 });
+}
+
+TEST(SeedCache, SupportsConcurrentAccess)
+{
+  ik::SeedCache cache(0.05);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&cache, t]() {
+      for (int i = 0; i < 1000; ++i)
+      {
+        const Eigen::Isometry3d target = createTarget(0.001 * i, 0.01 * t, 0.0);
+        cache.insert(target, { double(t), double(i) });
+        for (const std::vector<double>& seed : cache.getSeeds(target, 3))
+          EXPECT_EQ(seed.size(), 2);
+      }
+    });
+  }
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(cache.getSeeds(createTarget(0.0, 0.0, 0.0), 1).size(), 1);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/self_collision_sampling.h>
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace reach_ros;
+
+namespace
+{
+collision::SampledCollisions createCollisions()
+{
+  collision::SampledCollisions collisions;
+  collisions.n_samples = 10000;
+  collisions.never_colliding = { { "base_link", "link_3" }, { "link_1", "link_4" }, { "link_2", "tool0" } };
+  collisions.always_colliding = { { "base_link", "link_1" } };
+  return collisions;
+}
+
+}  // namespace
+
+TEST(SampledCollisions, ReadsWrittenCollisions)
+{
+  const collision::SampledCollisions collisions = createCollisions();
+  std::stringstream stream;
+  collisions.write(stream);
+
+  const std::shared_ptr<collision::SampledCollisions> read = collision::SampledCollisions::read(stream);
+  ASSERT_NE(read, nullptr);
+  EXPECT_EQ(read->n_samples, collisions.n_samples);
+  EXPECT_EQ(read->never_colliding, collisions.never_colliding);
+  EXPECT_EQ(read->always_colliding, collisions.always_colliding);
+}
+
+TEST(SampledCollisions, ReadsWrittenEmptyCollisions)
+{
+  collision::SampledCollisions collisions;
+  collisions.n_samples = 100;
+  std::stringstream stream;
+  collisions.write(stream);
+
+  const std::shared_ptr<collision::SampledCollisions> read = collision::SampledCollisions::read(stream);
+  ASSERT_NE(read, nullptr);
+  EXPECT_EQ(read->n_samples, collisions.n_samples);
+  EXPECT_TRUE(read->never_colliding.empty());
+  EXPECT_TRUE(read->always_colliding.empty());
+}
+
+TEST(SampledCollisions, RejectsTruncatedCollisions)
+{
+  std::stringstream stream;
+  createCollisions().write(stream);
+  const std::string data = stream.str();
+
+  // Truncated within the header or a line, e.g., by a full disk
+  for (std::size_t size : { std::size_t(0), std::size_t(3), data.size() - 1, data.size() - 4 })
+  {
+    std::stringstream truncated(data.substr(0, size));
+    EXPECT_EQ(collision::SampledCollisions::read(truncated), nullptr) << "Size " << size;
+  }
+}
+
+TEST(SampledCollisions, RejectsCorruptCollisions)
+{
+  // A file that is not a sampled collisions file
+  std::stringstream other("solid part\nfacet normal 0 0 1\n");
+  EXPECT_EQ(collision::SampledCollisions::read(other), nullptr);
+
+  // A line of an unknown type
+  std::stringstream unknown_type("RRACM1 100\nsometimes link_1 link_2\n");
+  EXPECT_EQ(collision::SampledCollisions::read(unknown_type), nullptr);
+
+  // A line with a missing link
+  std::stringstream missing_link("RRACM1 100\nnever link_1\nnever link_2 link_3\n");
+  EXPECT_EQ(collision::SampledCollisions::read(missing_link), nullptr);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/collision/signed_distance_field.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <geometric_shapes/shape_operations.h>
+#include <geometric_shapes/shapes.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace reach_ros;
+
+namespace
+{
+/** @brief Spacing (m) of the grids of the fields */
+const double RESOLUTION = 0.01;
+
+/** @brief Creates a sphere of latitude and longitude bands */
+std::shared_ptr<shapes::Mesh> createSphere(double radius, unsigned int n_bands)
+{
+  EigenSTL::vector_Vector3d vertices;
+  for (unsigned int i = 0; i <= n_bands; ++i)
+  {
+    const double theta = M_PI * i / n_bands;
+    for (unsigned int j = 0; j < 2 * n_bands; ++j)
+    {
+      const double phi = M_PI * j / n_bands;
+      const Eigen::Vector3d normal(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+      vertices.push_back(radius * normal);
+    }
+  }
+
+  std::vector<unsigned int> triangles;
+  for (unsigned int i = 0; i < n_bands; ++i)
+  {
+    for (unsigned int j = 0; j < 2 * n_bands; ++j)
+    {
+      const unsigned int a = i * 2 * n_bands + j;
+      const unsigned int b = i * 2 * n_bands + (j + 1) % (2 * n_bands);
+      triangles.insert(triangles.end(), { a, a + 2 * n_bands, b, b, a + 2 * n_bands, b + 2 * n_bands });
+    }
+  }
+
+  return std::shared_ptr<shapes::Mesh>(shapes::createMeshFromVertices(vertices, triangles));
+}
+
+/** @brief Creates a cube of the input size, centered on the origin */
+std::shared_ptr<shapes::Mesh> createCube(double size)
+{
+  EigenSTL::vector_Vector3d vertices;
+  for (unsigned int i = 0; i < 8; ++i)
+    vertices.push_back(0.5 * size * Eigen::Vector3d(i & 1 ? 1.0 : -1.0, i & 2 ? 1.0 : -1.0, i & 4 ? 1.0 : -1.0));
+
+  const std::vector<unsigned int> triangles = { 0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+                                                2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5 };
+  return std::shared_ptr<shapes::Mesh>(shapes::createMeshFromVertices(vertices, triangles));
+}
+
+/** @brief Computes the signed distance of a point from a cube of the input size, centered on the origin */
+double getCubeDistance(const Eigen::Vector3d& point, double size)
+{
+  const Eigen::Vector3d q = point.cwiseAbs() - Eigen::Vector3d::Constant(0.5 * size);
+  return q.cwiseMax(0.0).norm() + std::min(q.maxCoeff(), 0.0);
+}
+
+/** @brief Samples points uniformly in a cube of the input size, centered on the input center */
+std::vector<Eigen::Vector3d> samplePoints(const Eigen::Vector3d& center, double size, std::size_t n)
+{
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<double> dist(-0.5 * size, 0.5 * size);
+
+  std::vector<Eigen::Vector3d> points;
+  for (std::size_t i = 0; i < n; ++i)
+    points.push_back(center + Eigen::Vector3d(dist(rng), dist(rng), dist(rng)));
+  return points;
+}
+
+}  // namespace
+
+TEST(SignedDistanceField, MatchesSphere)
+{
+  const double radius = 0.1;
+  const double max_distance = 0.2;
+  const collision::SignedDistanceField sdf(*createSphere(radius, 48), Eigen::Isometry3d::Identity(), RESOLUTION,
+                                           max_distance);
+
+  for (const Eigen::Vector3d& point : samplePoints(Eigen::Vector3d::Zero(), 0.4, 2000))
+  {
+    // The distance has a kink at the center of the sphere, where interpolation is less accurate
+    if (point.norm() < 0.5 * radius)
+      continue;
+
+    const double expected = std::min(point.norm() - radius, max_distance);
+    EXPECT_NEAR(sdf.getDistance(point), expected, RESOLUTION) << "Point " << point.transpose();
+  }
+}
+
+TEST(SignedDistanceField, MatchesCube)
+{
+  const double size = 0.2;
+  const double max_distance = 0.1;
+  const collision::SignedDistanceField sdf(*createCube(size), Eigen::Isometry3d::Identity(), RESOLUTION,
+                                           max_distance);
+
+  for (const Eigen::Vector3d& point : samplePoints(Eigen::Vector3d::Zero(), 0.3, 2000))
+  {
+    const double expected = std::max(std::min(getCubeDistance(point, size), max_distance), -max_distance);
+    EXPECT_NEAR(sdf.getDistance(point), expected, RESOLUTION) << "Point " << point.transpose();
+  }
+}
+
+TEST(SignedDistanceField, InterpolatesBetweenGridPoints)
+{
+  // The distance to a cube is linear along a line normal to one of its faces, so interpolation between grid points is
+  // as accurate as the grid points themselves, wherever the line is
+  const double size = 0.2;
+  const collision::SignedDistanceField sdf(*createCube(size), Eigen::Isometry3d::Identity(), RESOLUTION, 0.1);
+
+  for (double x = 0.11; x < 0.15; x += 0.1 * RESOLUTION)
+    EXPECT_NEAR(sdf.getDistance(Eigen::Vector3d(x, 0.013, -0.027)), x - 0.5 * size, 0.1 * RESOLUTION) << "x " << x;
+}
+
+TEST(SignedDistanceField, AppliesMeshPose)
+{
+  const double radius = 0.1;
+  const Eigen::Isometry3d pose(Eigen::Translation3d(1.0, -2.0, 0.5));
+  const collision::SignedDistanceField sdf(*createSphere(radius, 48), pose, RESOLUTION, 0.2);
+
+  for (const Eigen::Vector3d& point : samplePoints(pose.translation(), 0.3, 500))
+  {
+    const Eigen::Vector3d offset = point - pose.translation();
+    if (offset.norm() < 0.5 * radius)
+      continue;
+
+    EXPECT_NEAR(sdf.getDistance(point), offset.norm() - radius, RESOLUTION) << "Point " << point.transpose();
+  }
+}
+
+TEST(SignedDistanceField, SaturatesBeyondGrid)
+{
+  const double max_distance = 0.05;
+  const collision::SignedDistanceField sdf(*createCube(0.2), Eigen::Isometry3d::Identity(), RESOLUTION, max_distance);
+
+  EXPECT_DOUBLE_EQ(sdf.getDistance(Eigen::Vector3d(10.0, 0.0, 0.0)), max_distance);
+  EXPECT_NEAR(sdf.getDistance(Eigen::Vector3d(0.0, 0.0, 0.0)), -max_distance, 1.0e-6);
+}
+
+TEST(SignedDistanceField, ReadsWrittenField)
+{
+  const collision::SignedDistanceField sdf(*createCube(0.2), Eigen::Isometry3d::Identity(), RESOLUTION, 0.05);
+  std::stringstream stream;
+  sdf.write(stream);
+
+  const std::shared_ptr<collision::SignedDistanceField> read = collision::SignedDistanceField::read(stream);
+  ASSERT_NE(read, nullptr);
+  EXPECT_EQ(read->getResolution(), sdf.getResolution());
+  EXPECT_EQ(read->getMaxDistance(), sdf.getMaxDistance());
+  for (const Eigen::Vector3d& point : samplePoints(Eigen::Vector3d::Zero(), 0.3, 100))
+    EXPECT_EQ(read->getDistance(point), sdf.getDistance(point));
+
+  // A truncated field is rejected
+  const std::string data = stream.str();
+  std::stringstream truncated(data.substr(0, data.size() / 2));
+  EXPECT_EQ(collision::SignedDistanceField::read(truncated), nullptr);
+}
+
+TEST(SignedDistanceField, RejectsCorruptField)
+{
+  const collision::SignedDistanceField sdf(*createCube(0.2), Eigen::Isometry3d::Identity(), RESOLUTION, 0.05);
+  std::stringstream stream;
+  sdf.write(stream);
+  const std::string data = stream.str();
+
+  // The header is the magic (8 bytes), the version (4 bytes), the origin, resolution, and maximum distance (5 doubles),
+  // and the size of the grid (3 64-bit integers)
+  const std::size_t version_offset = 8;
+  const std::size_t size_offset = version_offset + sizeof(std::uint32_t) + 5 * sizeof(double);
+  auto read = [](const std::string& data) {
+    std::stringstream stream(data);
+    return collision::SignedDistanceField::read(stream);
+  };
+  auto setSize = [&data, size_offset](const std::array<std::uint64_t, 3>& size) {
+    std::string corrupt = data;
+    corrupt.replace(size_offset, sizeof(size), reinterpret_cast<const char*>(size.data()), sizeof(size));
+    return corrupt;
+  };
+
+  // A field of another version
+  std::string corrupt = data;
+  const std::uint32_t version = collision::SignedDistanceField::VERSION + 1;
+  corrupt.replace(version_offset, sizeof(version), reinterpret_cast<const char*>(&version), sizeof(version));
+  EXPECT_EQ(read(corrupt), nullptr);
+
+  // A grid whose number of points overflows
+  const std::uint64_t huge = std::uint64_t(1) << 32;
+  EXPECT_EQ(read(setSize({ huge, huge, huge })), nullptr);
+
+  // A grid larger than the stream
+  EXPECT_EQ(read(setSize({ 1000, 1000, 100 })), nullptr);
+
+  // A grid too small to interpolate
+  EXPECT_EQ(read(setSize({ 1, 2, 2 })), nullptr);
+
+  EXPECT_NE(read(data), nullptr);
+}
+
+TEST(SignedDistanceField, WeldsSliverTriangles)
+{
+  // Add a sliver triangle along the edge of a cube on the x-axis at y = z = -0.1, whose apex is offset from the edge
+  // such that its normal points into the cube along the diagonal of the edge. Grid points on that diagonal outside
+  // of the cube are equidistant from the sliver and the adjacent faces, but their offsets are better aligned with the
+  // normal of the sliver, which would give them the wrong sign
+  const double size = 0.2;
+  std::shared_ptr<shapes::Mesh> cube = createCube(size);
+  EigenSTL::vector_Vector3d vertices;
+  for (unsigned int i = 0; i < cube->vertex_count; ++i)
+    vertices.emplace_back(cube->vertices[3 * i], cube->vertices[3 * i + 1], cube->vertices[3 * i + 2]);
+  std::vector<unsigned int> triangles(cube->triangles, cube->triangles + 3 * cube->triangle_count);
+
+  vertices.push_back(Eigen::Vector3d(0.0, -0.5 * size + 1.0e-9, -0.5 * size - 1.0e-9));
+  triangles.insert(triangles.end(), { 0, 1, static_cast<unsigned int>(vertices.size() - 1) });
+  std::shared_ptr<shapes::Mesh> mesh(shapes::createMeshFromVertices(vertices, triangles));
+
+  const double max_distance = 0.1;
+  const collision::SignedDistanceField sdf(*mesh, Eigen::Isometry3d::Identity(), RESOLUTION, max_distance);
+  EXPECT_TRUE(sdf.isClosed());
+  for (double offset = 0.0; offset < 3.0 * RESOLUTION; offset += 0.25 * RESOLUTION)
+  {
+    const Eigen::Vector3d point(0.013, -0.5 * size - offset, -0.5 * size - offset);
+    EXPECT_NEAR(sdf.getDistance(point), getCubeDistance(point, size), RESOLUTION) << "Offset " << offset;
+  }
+
+  for (const Eigen::Vector3d& point : samplePoints(Eigen::Vector3d::Zero(), 0.3, 2000))
+  {
+    const double expected = std::max(std::min(getCubeDistance(point, size), max_distance), -max_distance);
+    EXPECT_NEAR(sdf.getDistance(point), expected, RESOLUTION) << "Point " << point.transpose();
+  }
+}
+
+TEST(SignedDistanceField, DetectsOpenMesh)
+{
+  const Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  EXPECT_TRUE(collision::SignedDistanceField(*createCube(0.2), pose, RESOLUTION, 0.05).isClosed());
+  EXPECT_TRUE(collision::SignedDistanceField(*createSphere(0.1, 16), pose, RESOLUTION, 0.05).isClosed());
+
+  // Remove one face of the cube
+  std::shared_ptr<shapes::Mesh> cube = createCube(0.2);
+  EigenSTL::vector_Vector3d vertices;
+  for (unsigned int i = 0; i < cube->vertex_count; ++i)
+    vertices.emplace_back(cube->vertices[3 * i], cube->vertices[3 * i + 1], cube->vertices[3 * i + 2]);
+  std::vector<unsigned int> triangles(cube->triangles, cube->triangles + 3 * (cube->triangle_count - 2));
+  std::shared_ptr<shapes::Mesh> open(shapes::createMeshFromVertices(vertices, triangles));
+
+  const collision::SignedDistanceField sdf(*open, pose, RESOLUTION, 0.05);
+  EXPECT_FALSE(sdf.isClosed());
+
+  // The field survives being written and read
+  std::stringstream stream;
+  sdf.write(stream);
+  std::shared_ptr<collision::SignedDistanceField> copy = collision::SignedDistanceField::read(stream);
+  ASSERT_NE(copy, nullptr);
+  EXPECT_FALSE(copy->isClosed());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
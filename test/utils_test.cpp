@@ -0,0 +1,432 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/utils.h>
+
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <cmath>
+#include <fstream>
+#include <geometric_shapes/shape_operations.h>
+#include <geometric_shapes/shapes.h>
+#include <gtest/gtest.h>
+#include <limits>
+#include <moveit/collision_detection/world.h>
+#include <moveit/collision_detection_fcl/collision_env_fcl.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <stdexcept>
+#include <vector>
+
+using namespace reach_ros;
+
+namespace
+{
+/** @brief Temporary file that is removed when it goes out of scope */
+struct TemporaryFile
+{
+  TemporaryFile() : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.mesh"))
+  {
+  }
+
+  ~TemporaryFile()
+  {
+    boost::filesystem::remove(path);
+  }
+
+  boost::filesystem::path path;
+};
+
+/** @brief Creates a tetrahedron */
+std::shared_ptr<shapes::Mesh> createMesh()
+{
+  const EigenSTL::vector_Vector3d vertices = { Eigen::Vector3d(0.0, 0.0, 0.0), Eigen::Vector3d(1.0, 0.0, 0.0),
+                                               Eigen::Vector3d(0.0, 1.0, 0.0), Eigen::Vector3d(0.0, 0.0, 1.0) };
+  const std::vector<unsigned int> triangles = { 0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3 };
+  return std::shared_ptr<shapes::Mesh>(shapes::createMeshFromVertices(vertices, triangles));
+}
+
+void writeMesh(const boost::filesystem::path& path, const shapes::Mesh& mesh)
+{
+  std::ofstream stream(path.string(), std::ios::binary);
+  utils::writeCachedMesh(stream, mesh);
+}
+
+const double CUBE_SIZE = 0.1;
+const double PART_SIZE = 0.2;
+
+geometry_msgs::Pose createPose(double x, double y)
+{
+  geometry_msgs::Pose pose;
+  pose.position.x = x;
+  pose.position.y = y;
+  pose.orientation.w = 1.0;
+  return pose;
+}
+
+/**
+ * @brief Builds a robot with two cube links: one on a prismatic joint along the x-axis (at the origin by default) and
+ * one fixed 2 m along the y-axis
+ */
+moveit::core::RobotModelPtr createCubeModel()
+{
+  moveit::core::RobotModelBuilder builder("cube_robot", "base_link");
+  builder.addChain("base_link->near_link", "prismatic", { createPose(0.0, 0.0) }, urdf::Vector3(1.0, 0.0, 0.0));
+  builder.addChain("base_link->far_link", "fixed", { createPose(0.0, 2.0) });
+  builder.addCollisionBox("near_link", { CUBE_SIZE, CUBE_SIZE, CUBE_SIZE }, createPose(0.0, 0.0));
+  builder.addCollisionBox("far_link", { CUBE_SIZE, CUBE_SIZE, CUBE_SIZE }, createPose(0.0, 0.0));
+  builder.addGroupChain("base_link", "near_link", "near");
+  return builder.build();
+}
+
+/** @brief Creates a world with a cube part centered 1 m along the x-axis */
+collision_detection::WorldPtr createPartWorld()
+{
+  auto world = std::make_shared<collision_detection::World>();
+  world->addToObject("part", std::make_shared<shapes::Box>(PART_SIZE, PART_SIZE, PART_SIZE),
+                     Eigen::Isometry3d(Eigen::Translation3d(1.0, 0.0, 0.0)));
+  return world;
+}
+
+/** @brief Returns the state of the cube robot with the center of its near link at the input x-coordinate */
+moveit::core::RobotState createState(const moveit::core::RobotModelConstPtr& model, double x)
+{
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+  state.setJointGroupPositions(model->getJointModelGroup("near"), std::vector<double>{ x });
+  state.update();
+  return state;
+}
+
+}  // namespace
+
+TEST(ParallelFor, VisitsEveryIndexOnce)
+{
+  const std::size_t n = 1000;
+  std::vector<std::atomic<int>> visits(n);
+  for (std::atomic<int>& v : visits)
+    v = 0;
+
+  utils::parallelFor(n, 4, [&](std::size_t i) {
+    ++visits[i];
+    return true;
+  });
+
+  for (std::size_t i = 0; i < n; ++i)
+    EXPECT_EQ(visits[i].load(), 1) << "Index " << i;
+}
+
+TEST(ParallelFor, StopsEarly)
+{
+  // The calling thread alone visits the indices in order, so it stops exactly at the index that returned false
+  std::size_t n_visited = 0;
+  utils::parallelFor(100, 1, [&](std::size_t i) {
+    ++n_visited;
+    return i < 10;
+  });
+  EXPECT_EQ(n_visited, 11);
+
+  // With more threads, only indices claimed before the stop was observed may still be started, at most one per thread
+  const std::size_t max_threads = 4;
+  std::atomic<bool> stopped{ false };
+  std::atomic<std::size_t> n_started_after_stop{ 0 };
+  utils::parallelFor(10000, max_threads, [&](std::size_t i) {
+    if (stopped)
+      ++n_started_after_stop;
+    if (i == 10)
+    {
+      stopped = true;
+      return false;
+    }
+    return true;
+  });
+  EXPECT_LE(n_started_after_stop.load(), max_threads - 1);
+}
+
+TEST(ParallelFor, PropagatesException)
+{
+  for (std::size_t max_threads : { 1, 4 })
+  {
+    std::atomic<std::size_t> n_visited{ 0 };
+    EXPECT_THROW(utils::parallelFor(10000, max_threads,
+                                    [&](std::size_t i) {
+                                      ++n_visited;
+                                      if (i == 10)
+                                        throw std::runtime_error("Failure at index 10");
+                                      return true;
+                                    }),
+                 std::runtime_error);
+
+    // The exception stops the iteration like a false return value does
+    EXPECT_LT(n_visited.load(), 10000);
+  }
+}
+
+TEST(ParallelFor, AllowsNestedCalls)
+{
+  // Nested calls must not deadlock, even when the outer call occupies every thread of the pool
+  std::atomic<std::size_t> n_visited{ 0 };
+  utils::parallelFor(16, 16, [&](std::size_t) {
+    utils::parallelFor(16, 16, [&](std::size_t) {
+      ++n_visited;
+      return true;
+    });
+    return true;
+  });
+  EXPECT_EQ(n_visited.load(), 16 * 16);
+}
+
+TEST(ParallelFor, HandlesEmptyRange)
+{
+  bool called = false;
+  utils::parallelFor(0, 4, [&](std::size_t) {
+    called = true;
+    return true;
+  });
+  EXPECT_FALSE(called);
+}
+
+TEST(MeshCache, ReadsWrittenMesh)
+{
+  const std::shared_ptr<shapes::Mesh> mesh = createMesh();
+  TemporaryFile file;
+  writeMesh(file.path, *mesh);
+
+  const std::shared_ptr<const shapes::Mesh> result = utils::readCachedMesh(file.path.string());
+  ASSERT_NE(result, nullptr);
+  ASSERT_EQ(result->vertex_count, mesh->vertex_count);
+  ASSERT_EQ(result->triangle_count, mesh->triangle_count);
+  EXPECT_TRUE(std::equal(mesh->vertices, mesh->vertices + 3 * mesh->vertex_count, result->vertices));
+  EXPECT_TRUE(std::equal(mesh->triangles, mesh->triangles + 3 * mesh->triangle_count, result->triangles));
+
+  // Normals are not stored, but are computed on reading
+  EXPECT_NE(result->triangle_normals, nullptr);
+  EXPECT_NE(result->vertex_normals, nullptr);
+}
+
+TEST(MeshCache, RejectsMissingFile)
+{
+  TemporaryFile file;
+  EXPECT_EQ(utils::readCachedMesh(file.path.string()), nullptr);
+}
+
+TEST(MeshCache, RejectsFileOfWrongSize)
+{
+  const std::shared_ptr<shapes::Mesh> mesh = createMesh();
+  TemporaryFile file;
+
+  // Truncated, e.g., by a full disk
+  writeMesh(file.path, *mesh);
+  boost::filesystem::resize_file(file.path, boost::filesystem::file_size(file.path) - 1);
+  EXPECT_EQ(utils::readCachedMesh(file.path.string()), nullptr);
+
+  // Extended with trailing data
+  writeMesh(file.path, *mesh);
+  {
+    std::ofstream stream(file.path.string(), std::ios::binary | std::ios::app);
+    stream << "x";
+  }
+  EXPECT_EQ(utils::readCachedMesh(file.path.string()), nullptr);
+
+  // Counts that claim more data than the file holds, which must not be allocated
+  writeMesh(file.path, *mesh);
+  {
+    std::fstream stream(file.path.string(), std::ios::binary | std::ios::in | std::ios::out);
+    const std::uint32_t vertex_count = 0xffffffff;
+    stream.seekp(8);
+    stream.write(reinterpret_cast<const char*>(&vertex_count), sizeof(vertex_count));
+  }
+  EXPECT_EQ(utils::readCachedMesh(file.path.string()), nullptr);
+}
+
+TEST(MeshCache, RejectsCorruptFile)
+{
+  const std::shared_ptr<shapes::Mesh> mesh = createMesh();
+  TemporaryFile file;
+
+  // A file that is not a mesh cache file
+  {
+    std::ofstream stream(file.path.string(), std::ios::binary);
+    stream << std::string(256, 'x');
+  }
+  EXPECT_EQ(utils::readCachedMesh(file.path.string()), nullptr);
+
+  // A triangle that refers to a vertex that does not exist
+  mesh->triangles[5] = mesh->vertex_count;
+  writeMesh(file.path, *mesh);
+  EXPECT_EQ(utils::readCachedMesh(file.path.string()), nullptr);
+}
+
+TEST(LinkModels, FindsLinksByName)
+{
+  const moveit::core::RobotModelPtr model = createCubeModel();
+  const std::set<const moveit::core::LinkModel*> links = utils::getLinkModels(model, { "near_link", "far_link" });
+  EXPECT_EQ(links.size(), 2u);
+  EXPECT_EQ(links.count(model->getLinkModel("near_link")), 1u);
+  EXPECT_EQ(links.count(model->getLinkModel("far_link")), 1u);
+  EXPECT_TRUE(utils::getLinkModels(model, {}).empty());
+}
+
+TEST(LinkModels, RejectsUnknownLink)
+{
+  const moveit::core::RobotModelPtr model = createCubeModel();
+  EXPECT_THROW(utils::getLinkModels(model, { "near_link", "missing_link" }), std::runtime_error);
+}
+
+TEST(DistanceToWorld, RestrictsQueryToLinks)
+{
+  const moveit::core::RobotModelPtr model = createCubeModel();
+  const collision_detection::CollisionEnvFCL env(model, createPartWorld());
+  const collision_detection::AllowedCollisionMatrix acm;
+  const moveit::core::RobotState state = createState(model, 0.0);
+
+  // The near link is closest to the part, along the x-axis
+  const double near_distance = 1.0 - 0.5 * (CUBE_SIZE + PART_SIZE);
+  EXPECT_NEAR(utils::getDistanceToWorld(env, state, acm, {}), near_distance, 1.0e-4);
+  EXPECT_NEAR(utils::getDistanceToWorld(env, state, acm, utils::getLinkModels(model, { "near_link" })), near_distance,
+              1.0e-4);
+
+  // The far link is offset along both the x- and y-axes
+  const double far_distance = std::hypot(near_distance, 2.0 - 0.5 * (CUBE_SIZE + PART_SIZE));
+  EXPECT_NEAR(utils::getDistanceToWorld(env, state, acm, utils::getLinkModels(model, { "far_link" })), far_distance,
+              1.0e-4);
+}
+
+TEST(DistanceToWorld, ClampsToMaxDistance)
+{
+  const moveit::core::RobotModelPtr model = createCubeModel();
+  const collision_detection::CollisionEnvFCL env(model, createPartWorld());
+  const collision_detection::AllowedCollisionMatrix acm;
+  const moveit::core::RobotState state = createState(model, 0.0);
+  const double distance = 1.0 - 0.5 * (CUBE_SIZE + PART_SIZE);
+
+  // Distances beyond the bound are returned as the bound itself
+  EXPECT_EQ(utils::getDistanceToWorld(env, state, acm, {}, 0.5), 0.5);
+  EXPECT_EQ(utils::getDistanceToWorld(env, state, acm, utils::getLinkModels(model, { "far_link" }), 1.0), 1.0);
+
+  // Distances within the bound are exact
+  EXPECT_NEAR(utils::getDistanceToWorld(env, state, acm, {}, 1.0), distance, 1.0e-4);
+  EXPECT_NEAR(utils::getDistanceToWorld(env, createState(model, 0.5), acm, {}, 0.5), distance - 0.5, 1.0e-4);
+}
+
+TEST(DistanceQueryKey, IdentifiesQuery)
+{
+  const moveit::core::RobotModelPtr model = createCubeModel();
+  const collision_detection::WorldPtr world = createPartWorld();
+  planning_scene::PlanningScene scene(model, world);
+  const std::uint64_t key = utils::getDistanceQueryKey(scene, {});
+
+  // Scenes on the same world with the same allowed collisions share the key
+  EXPECT_EQ(utils::getDistanceQueryKey(planning_scene::PlanningScene(model, world), {}), key);
+
+  // Listing every link with collision geometry is the same query as listing none
+  EXPECT_EQ(utils::getDistanceQueryKey(scene, utils::getLinkModels(model, { "near_link", "far_link" })), key);
+  EXPECT_NE(utils::getDistanceQueryKey(scene, utils::getLinkModels(model, { "far_link" })), key);
+
+  // An identical world is a different query, since the world itself may change independently
+  EXPECT_NE(utils::getDistanceQueryKey(planning_scene::PlanningScene(model, createPartWorld()), {}), key);
+}
+
+TEST(DistanceQueryKey, ChangesWithAllowedCollisions)
+{
+  const moveit::core::RobotModelPtr model = createCubeModel();
+  planning_scene::PlanningScene scene(model, createPartWorld());
+  const std::uint64_t key = utils::getDistanceQueryKey(scene, {});
+  const std::uint64_t far_key = utils::getDistanceQueryKey(scene, utils::getLinkModels(model, { "far_link" }));
+
+  scene.getAllowedCollisionMatrixNonConst().setEntry("part", "near_link", true);
+  EXPECT_NE(utils::getDistanceQueryKey(scene, {}), key);
+
+  // Allowed collisions of links outside of the query do not change it
+  EXPECT_EQ(utils::getDistanceQueryKey(scene, utils::getLinkModels(model, { "far_link" })), far_key);
+}
+
+TEST(DistanceQueryKey, ChangesWithWorldObjects)
+{
+  const moveit::core::RobotModelPtr model = createCubeModel();
+  planning_scene::PlanningScene scene(model, createPartWorld());
+  const std::uint64_t key = utils::getDistanceQueryKey(scene, {});
+
+  scene.getWorldNonConst()->addToObject("obstacle", std::make_shared<shapes::Box>(PART_SIZE, PART_SIZE, PART_SIZE),
+                                        Eigen::Isometry3d(Eigen::Translation3d(-1.0, 0.0, 0.0)));
+  EXPECT_NE(utils::getDistanceQueryKey(scene, {}), key);
+}
+
+TEST(DistanceMemo, ReusesDistanceOfSameQuery)
+{
+  const moveit::core::RobotModelPtr model = createCubeModel();
+  const moveit::core::RobotState state = createState(model, 0.1);
+  std::size_t n_computed = 0;
+  auto compute = [&n_computed]() {
+    ++n_computed;
+    return 0.3;
+  };
+
+  const double max_distance = std::numeric_limits<double>::max();
+  EXPECT_EQ(utils::memoizeDistance(1, state, max_distance, compute), 0.3);
+  EXPECT_EQ(utils::memoizeDistance(1, state, max_distance, compute), 0.3);
+  EXPECT_EQ(n_computed, 1u);
+
+  // A different query or state misses
+  EXPECT_EQ(utils::memoizeDistance(2, state, max_distance, compute), 0.3);
+  EXPECT_EQ(n_computed, 2u);
+  EXPECT_EQ(utils::memoizeDistance(1, createState(model, 0.2), max_distance, compute), 0.3);
+  EXPECT_EQ(n_computed, 3u);
+
+  // Only the most recent queries are kept
+  for (int i = 0; i < 16; ++i)
+    utils::memoizeDistance(1, createState(model, 1.0 + i), max_distance, compute);
+  n_computed = 0;
+  utils::memoizeDistance(1, state, max_distance, compute);
+  EXPECT_EQ(n_computed, 1u);
+}
+
+TEST(DistanceMemo, RespectsMaxDistance)
+{
+  const moveit::core::RobotModelPtr model = createCubeModel();
+  std::size_t n_computed = 0;
+  double distance = 0.0;
+  auto compute = [&]() {
+    ++n_computed;
+    return distance;
+  };
+
+  // A distance below its bound is exact, so it is reused for any bound
+  const moveit::core::RobotState exact_state = createState(model, 0.3);
+  distance = 0.3;
+  EXPECT_EQ(utils::memoizeDistance(3, exact_state, 0.5, compute), 0.3);
+  EXPECT_EQ(utils::memoizeDistance(3, exact_state, 1.0, compute), 0.3);
+  EXPECT_EQ(utils::memoizeDistance(3, exact_state, 0.2, compute), 0.2);
+  EXPECT_EQ(n_computed, 1u);
+
+  // A distance at its bound is only known to be at least that bound, so it is not reused for a greater bound
+  const moveit::core::RobotState clamped_state = createState(model, 0.4);
+  distance = 0.5;
+  EXPECT_EQ(utils::memoizeDistance(3, clamped_state, 0.5, compute), 0.5);
+  EXPECT_EQ(utils::memoizeDistance(3, clamped_state, 0.4, compute), 0.4);
+  EXPECT_EQ(n_computed, 2u);
+
+  distance = 0.8;
+  EXPECT_EQ(utils::memoizeDistance(3, clamped_state, 1.0, compute), 0.8);
+  EXPECT_EQ(n_computed, 3u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
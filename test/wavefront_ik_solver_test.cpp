@@ -0,0 +1,185 @@
+/*
+ * Copyright 2019 Southwest Research Institute
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <reach_ros/ik/wavefront_ik_solver.h>
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace reach_ros;
+
+namespace
+{
+/**
+ * @brief IK solver of a single joint whose solution is one more than its seed, such that the solution of a target
+ * tells how many times its seed has been propagated
+ */
+class SeedCountingIKSolver : public reach::IKSolver
+{
+public:
+  std::vector<std::vector<double>> solveIK(const Eigen::Isometry3d& target,
+                                           const std::map<std::string, double>& seed) const override
+  {
+    const double x = target.translation().x();
+    const double j = seed.at("j");
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      calls.emplace_back(x, j);
+    }
+
+    if (failing.count(x) || (j != 0.0 && failing_from_neighbors.count(x)))
+      return {};
+
+    return { { j + 1.0 } };
+  }
+
+  std::vector<std::string> getJointNames() const override
+  {
+    return { "j" };
+  }
+
+  std::size_t getNumCalls(double x) const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<std::size_t>(std::count_if(
+        calls.begin(), calls.end(), [x](const std::pair<double, double>& call) { return call.first == x; }));
+  }
+
+  /** @brief Targets (by x-coordinate) that fail from any seed */
+  std::set<double> failing;
+  /** @brief Targets (by x-coordinate) that fail from any seed other than the input seed */
+  std::set<double> failing_from_neighbors;
+
+  mutable std::mutex mutex;
+  mutable std::vector<std::pair<double, double>> calls;
+};
+
+/** @brief Targets on a line, whose neighbors within the neighbor radius are the adjacent targets */
+const std::vector<double> TARGETS = { 0.0, 0.1, 0.2, 0.3, 0.4 };
+const double NEIGHBOR_RADIUS = 0.15;
+
+Eigen::Isometry3d createTarget(double x)
+{
+  return Eigen::Isometry3d(Eigen::Translation3d(x, 0.0, 0.0));
+}
+
+std::shared_ptr<ik::WavefrontIKSolver> createSolver(std::shared_ptr<const SeedCountingIKSolver> ik_solver)
+{
+  reach::VectorIsometry3d targets;
+  for (double x : TARGETS)
+    targets.push_back(createTarget(x));
+
+  // The single anchor is the target nearest to the centroid, at x = 0.2
+  return std::make_shared<ik::WavefrontIKSolver>(ik_solver, targets, NEIGHBOR_RADIUS, 1, 2);
+}
+
+const std::map<std::string, double> SEED = { { "j", 0.0 } };
+
+}  // namespace
+
+TEST(WavefrontIKSolver, SeedsTargetsFromNeighbors)
+{
+  auto ik_solver = std::make_shared<SeedCountingIKSolver>();
+  std::shared_ptr<ik::WavefrontIKSolver> solver = createSolver(ik_solver);
+
+  // The anchor is solved from the input seed, and each frontier from the solutions of the previous one
+  const std::vector<double> expected = { 3.0, 2.0, 1.0, 2.0, 3.0 };
+  for (std::size_t i = 0; i < TARGETS.size(); ++i)
+  {
+    const std::vector<std::vector<double>> solutions = solver->solveIK(createTarget(TARGETS[i]), SEED);
+    ASSERT_EQ(solutions.size(), 1u) << "Target " << TARGETS[i];
+    EXPECT_EQ(solutions.front().front(), expected[i]) << "Target " << TARGETS[i];
+    EXPECT_EQ(ik_solver->getNumCalls(TARGETS[i]), 1u) << "Target " << TARGETS[i];
+  }
+
+  // Later requests are solved by the wrapped solver from their own seed
+  const std::vector<std::vector<double>> solutions = solver->solveIK(createTarget(TARGETS.front()), SEED);
+  ASSERT_EQ(solutions.size(), 1u);
+  EXPECT_EQ(solutions.front().front(), 1.0);
+  EXPECT_EQ(ik_solver->getNumCalls(TARGETS.front()), 2u);
+}
+
+TEST(WavefrontIKSolver, RecordsFailedTargets)
+{
+  auto ik_solver = std::make_shared<SeedCountingIKSolver>();
+  ik_solver->failing = { 0.4 };
+  ik_solver->failing_from_neighbors = { 0.3 };
+  std::shared_ptr<ik::WavefrontIKSolver> solver = createSolver(ik_solver);
+
+  // Targets that fail from the solution of a neighbor are retried from the input seed
+  std::vector<std::vector<double>> solutions = solver->solveIK(createTarget(0.3), SEED);
+  ASSERT_EQ(solutions.size(), 1u);
+  EXPECT_EQ(solutions.front().front(), 1.0);
+  EXPECT_EQ(ik_solver->getNumCalls(0.3), 2u);
+
+  // The first request for a target that failed returns the failure without solving it again
+  EXPECT_TRUE(solver->solveIK(createTarget(0.4), SEED).empty());
+  EXPECT_EQ(ik_solver->getNumCalls(0.4), 2u);
+
+  EXPECT_TRUE(solver->solveIK(createTarget(0.4), SEED).empty());
+  EXPECT_EQ(ik_solver->getNumCalls(0.4), 3u);
+}
+
+TEST(WavefrontIKSolver, SolvesTargetsOutsideOfTargetSet)
+{
+  auto ik_solver = std::make_shared<SeedCountingIKSolver>();
+  std::shared_ptr<ik::WavefrontIKSolver> solver = createSolver(ik_solver);
+
+  const std::vector<std::vector<double>> solutions = solver->solveIK(createTarget(1.0), SEED);
+  ASSERT_EQ(solutions.size(), 1u);
+  EXPECT_EQ(solutions.front().front(), 1.0);
+  EXPECT_EQ(ik_solver->getNumCalls(1.0), 1u);
+}
+
+TEST(WavefrontIKSolver, ServesEachTargetOnce)
+{
+  auto ik_solver = std::make_shared<SeedCountingIKSolver>();
+  std::shared_ptr<ik::WavefrontIKSolver> solver = createSolver(ik_solver);
+
+  // Concurrent requests for every target, of which only the first for each target is served from the propagation
+  const std::size_t n_threads = 4;
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < n_threads; ++t)
+  {
+    threads.emplace_back([&solver]() {
+      for (double x : TARGETS)
+        EXPECT_EQ(solver->solveIK(createTarget(x), SEED).size(), 1u) << "Target " << x;
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (double x : TARGETS)
+    EXPECT_EQ(ik_solver->getNumCalls(x), n_threads) << "Target " << x;
+}
+
+TEST(WavefrontIKSolver, RejectsInvalidParameters)
+{
+  reach::VectorIsometry3d targets = { createTarget(0.0) };
+  EXPECT_THROW(ik::WavefrontIKSolver(nullptr, targets, NEIGHBOR_RADIUS, 1, 1), std::runtime_error);
+  EXPECT_THROW(ik::WavefrontIKSolver(std::make_shared<SeedCountingIKSolver>(), targets, 0.0, 1, 1),
+               std::runtime_error);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}